@@ -0,0 +1,419 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+//Decodes frames as the devices of the device description files send and receive them with the compiled DecodePlan and
+//with the per-frame decoding MAXPeer::getValuesFromPacket() used before. The values have to be the same and in the same
+//order, because MAXPeer sets and raises them in the order they are returned. Afterwards the speed of both is compared.
+//The exit code is 1 when the results differ.
+//Usage: DecodePlanTest [device description directory] [rounds]
+
+#include "GD.h"
+#include "DecodePlan.h"
+#include "ParameterIndex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <tuple>
+
+#ifndef DEVICEDESCRIPTIONPATH
+#define DEVICEDESCRIPTIONPATH "misc/Device Description Files/"
+#endif
+
+using namespace MAX;
+using namespace BaseLib::DeviceDescription;
+
+namespace
+{
+const int32_t peerAddress = 0x123456;
+
+//Parameter ID, channel, value
+typedef std::vector<std::tuple<std::string, uint32_t, std::vector<uint8_t>>> Values;
+
+class FrameValue
+{
+public:
+	std::list<uint32_t> channels;
+	std::vector<uint8_t> value;
+};
+
+class FrameValues
+{
+public:
+	std::list<uint32_t> paramsetChannels;
+	ParameterGroup::Type::Enum parameterSetType;
+	std::map<std::string, FrameValue> values;
+};
+
+class DeviceFrames
+{
+public:
+	std::string file;
+	std::vector<std::string> packets;
+};
+
+//Packets of the peer 0x123456 and its central 0x000001. Besides the frames of each device description they contain
+//frames with a wrong length, frames too short for all fields, frames failing const values and frames of other devices.
+const std::vector<DeviceFrames> deviceFrames
+{
+	{"BC-RT-TRX-CyG.xml", {
+		"0F0504601234560000010019202B00D5", //INFO_LEVEL, manual mode, valve 32 %, 21.5 °C set, 21.3 °C measured
+		"0F0604601234560000010098002400C8", //INFO_LEVEL, auto mode, low battery
+		"1007046012345600000100BA002C9D0B24", //INFO_LEVEL_PARTY, locked, until 29.08.2011 18:00
+		"0E0804601234560000010019202B00", //Wrong length
+		"0B08044012345600000100AB", //INFO_LEVEL2, too short for the party fields
+		"0E09020212345600000100011A002C", //ACK_STATUS
+		"0B0A0440000001123456012B", //Set temperature from the central, no const value matches
+		"0B0A0440000001123456016B", //Manual mode from the central
+		"0A0B00FF12345600000100", //INFO_POWERON
+		"0B0C06301234560000000012" //Wrong message type
+	}},
+	{"BC-RT-TRX-CyG-2.xml", {
+		"0F0D04601234560000010019202B00D5",
+		"1007046012345600000100BA002C9D0B24",
+		"0E0E020212345600000100011A002C",
+		"0A0F00FF12345600000100"
+	}},
+	{"BC-RT-TRX-CyG-3.xml", {
+		"0F1004601234560000010039002B00D8",
+		"1007046012345600000100BA002C9D0B24",
+		"0E1104401234560000010022A58A12", //INFO_LEVEL2 with party end
+		"0A1200FF12345600000100"
+	}},
+	{"BC-RT-TRX-CyN.xml", {
+		"0F1304601234560000010019202B00D5",
+		"0E14020212345600000100011A002C",
+		"0F1504601234569876540019202B00D5" //Not sent to the central
+	}},
+	{"BC-TC-C-WM-2.xml", {
+		"0C16044212345600000100ABD5", //INFO_LEVEL, measured temperature split over two bytes
+		"0C170442123456000001002B04",
+		"0F1804701234560000010019002B00D5", //INFO_LEVEL3
+		"1019047012345600000100BA002C9D0B24", //INFO_LEVEL3_PARTY
+		"0B1A00401234560000010069", //INFO_LEVEL2
+		"0E1B020212345600000100011900A4",
+		"0A1C00FF12345600000100"
+	}},
+	{"BC-TC-C-WM-4.xml", {
+		"0C1D044212345600000100ABD5",
+		"0F1E04701234560000010019002B00D5",
+		"0E1F00401234560000010022A58A12"
+	}},
+	{"BC-SC-Rd-WM.xml", {
+		"0B2006301234560000000012", //EVENT, open
+		"0B2106301234560000000090", //EVENT, closed, low battery
+		"0C22020212345600000100010A", //ACK_STATUS
+		"0B2306306543210000000012", //Other device
+		"0A2400FF12345600000100"
+	}},
+	{"BC-SC-Rd-WM-2.xml", {
+		"0B2506301234560000000012",
+		"0C26020212345600000100018A"
+	}},
+	{"BC-PB-2-WM.xml", {
+		"0C270650123456000000000001", //KEY_EVENT, channel 1
+		"0C28065012345600000000B002", //KEY_EVENT, channel 2, low battery
+		"0C290650123456000000000009", //KEY_EVENT, unknown channel
+		"0C2A020212345600000100010A"
+	}},
+	{"BC-TS-Sw-Pl.xml", {
+		"0B2B0040123456000001006B", //INFO_LEVEL
+		"0D2C04601234560000010001002B", //INFO_LEVEL2
+		"0E2D0202123456000001000101002B"
+	}}
+};
+
+//MAXPeer::getValuesFromPacket() before the decode plan was introduced. It is the reference the plan is checked against,
+//so it must not be changed along with the plan. Setting LOWBAT is replaced by returning it.
+void decodePerFrame(PHomegearDevice& device, std::shared_ptr<MAXPacket>& packet, std::vector<FrameValues>& frameValues, int32_t& lowBat)
+{
+	lowBat = -1;
+	if(device->packetsByMessageType.find(packet->messageType()) == device->packetsByMessageType.end()) return;
+	std::pair<PacketsByMessageType::iterator, PacketsByMessageType::iterator> range = device->packetsByMessageType.equal_range((uint32_t)packet->messageType());
+	if(range.first == device->packetsByMessageType.end()) return;
+	PacketsByMessageType::iterator i = range.first;
+	do
+	{
+		FrameValues currentFrameValues;
+		PPacket frame(i->second);
+		if(!frame) continue;
+		if(frame->direction == Packet::Direction::Enum::toCentral && packet->senderAddress() != peerAddress) continue;
+		if(frame->direction == Packet::Direction::Enum::fromCentral && packet->destinationAddress() != peerAddress) continue;
+		if(packet->payload().empty()) break;
+		if(frame->subtype > -1 && packet->messageSubtype() != frame->subtype) continue;
+		int32_t channelIndex = frame->channelIndex;
+		int32_t channel = -1;
+		if(channelIndex >= 9 && (signed)packet->payload().size() > (channelIndex - 9)) channel = packet->payload().at(channelIndex - 9) - frame->channelIndexOffset;
+		if(channel > -1 && frame->channelSize < 1.0) channel &= (0xFF >> (8 - std::lround(frame->channelSize * 10) % 10));
+		if(frame->channel > -1) channel = frame->channel;
+		if(frame->length > 0 && packet->length() != frame->length) continue;
+
+		for(BinaryPayloads::iterator j = frame->binaryPayloads.begin(); j != frame->binaryPayloads.end(); ++j)
+		{
+			std::vector<uint8_t> data;
+			if((*j)->size > 0 && (*j)->index > 0)
+			{
+				if(((int32_t)(*j)->index) - 9 >= (signed)packet->payload().size()) continue;
+				data = packet->getPosition((*j)->index, (*j)->size, -1);
+
+				if((*j)->constValueInteger > -1)
+				{
+					int32_t intValue = 0;
+					GD::bl->hf.memcpyBigEndian(intValue, data);
+					if(intValue != (*j)->constValueInteger) break; else continue;
+				}
+
+				//Process split data
+				if((*j)->size2 > 0 && (*j)->index2 > 0 && (*j)->index2Offset > 0) //Only
+				{
+					if((*j)->size2 > 1.0) GD::out.printWarning("Warning: size2 of frame parameter is larger than 1 byte. That is not supported.");
+					else if(((int32_t)(*j)->index2) - 9 < (signed)packet->payload().size())
+					{
+						std::vector<uint8_t> data2 = packet->getPosition((*j)->index2, (*j)->size2, -1);
+						int32_t byteIndex = (*j)->index2Offset / 8;
+						int32_t bitIndex = (*j)->index2Offset % 8;
+						if(data2.size() == 1)
+						{
+							if(byteIndex < (signed)data.size())
+							{
+								data.at(byteIndex) |= (data2.at(0) << bitIndex);
+							}
+							else
+							{
+								data2.insert(data2.end(), data.begin(), data.end());
+								data = data2;
+							}
+						}
+					}
+				}
+			}
+			else if((*j)->constValueInteger > -1)
+			{
+				GD::bl->hf.memcpyBigEndian(data, (*j)->constValueInteger);
+			}
+			else continue;
+
+			if((*j)->parameterId == "LOWBAT") lowBat = (data.size() > 0 && data.at(0)) ? 1 : 0;
+
+			for(std::vector<PParameter>::iterator k = frame->associatedVariables.begin(); k != frame->associatedVariables.end(); ++k)
+			{
+				if((*k)->physical->groupId != (*j)->parameterId) continue;
+				currentFrameValues.parameterSetType = (*k)->parent()->type();
+				bool setValues = false;
+				if(currentFrameValues.paramsetChannels.empty()) //Fill paramsetChannels
+				{
+					int32_t startChannel = (channel < 0) ? 0 : channel;
+					int32_t endChannel;
+					//When fixedChannel is -2 (means '*') cycle through all channels
+					if(frame->channel == -2)
+					{
+						startChannel = 0;
+						endChannel = device->functions.rbegin()->first;
+					}
+					else endChannel = startChannel;
+					for(int32_t l = startChannel; l <= endChannel; l++)
+					{
+						Functions::iterator functionIterator = device->functions.find(l);
+						if(functionIterator == device->functions.end()) continue;
+						PParameterGroup parameterGroup = functionIterator->second->getParameterGroup(currentFrameValues.parameterSetType);
+						if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
+						currentFrameValues.paramsetChannels.push_back(l);
+						currentFrameValues.values[(*k)->id].channels.push_back(l);
+						setValues = true;
+					}
+				}
+				else //Use paramsetChannels
+				{
+					for(std::list<uint32_t>::const_iterator l = currentFrameValues.paramsetChannels.begin(); l != currentFrameValues.paramsetChannels.end(); ++l)
+					{
+						Functions::iterator functionIterator = device->functions.find(*l);
+						if(functionIterator == device->functions.end()) continue;
+						PParameterGroup parameterGroup = functionIterator->second->getParameterGroup(currentFrameValues.parameterSetType);
+						if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
+						currentFrameValues.values[(*k)->id].channels.push_back(*l);
+						setValues = true;
+					}
+				}
+				if(setValues) currentFrameValues.values[(*k)->id].value = data;
+			}
+		}
+		if(!currentFrameValues.values.empty()) frameValues.push_back(currentFrameValues);
+	} while(++i != range.second && i != device->packetsByMessageType.end());
+}
+
+//The values in the order MAXPeer processed them before the decode plan: frame by frame, by parameter ID and by channel
+Values flatten(std::vector<FrameValues>& frameValues)
+{
+	Values values;
+	for(auto& frame : frameValues)
+	{
+		for(auto& value : frame.values)
+		{
+			for(auto channel : frame.paramsetChannels)
+			{
+				if(std::find(value.second.channels.begin(), value.second.channels.end(), channel) == value.second.channels.end()) continue;
+				values.emplace_back(value.first, channel, value.second.value);
+			}
+		}
+	}
+	return values;
+}
+
+Values flatten(ParameterIndex& parameterIndex, DecodeResult& result)
+{
+	Values values;
+	for(uint32_t i = 0; i < result.size(); i++)
+	{
+		DecodedValue& value = result.at(i);
+		values.emplace_back(parameterIndex.getName(value.parameterIndex), value.channel, value.value);
+	}
+	return values;
+}
+
+std::string toString(const Values& values)
+{
+	std::string result;
+	for(auto& value : values)
+	{
+		if(!result.empty()) result.append(", ");
+		result.append(std::get<0>(value) + ":" + std::to_string(std::get<1>(value)) + "=" + BaseLib::HelperFunctions::getHexString(std::get<2>(value)));
+	}
+	return result;
+}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string path = argc > 1 ? argv[1] : DEVICEDESCRIPTIONPATH;
+	if(!path.empty() && path.back() != '/') path.push_back('/');
+	uint32_t rounds = argc > 2 ? std::stoul(argv[2]) : 10000;
+	if(rounds == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [device description directory] [rounds]" << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<BaseLib::SharedObjects> bl(new BaseLib::SharedObjects(false));
+	GD::bl = bl.get();
+	GD::out.init(bl.get());
+	GD::out.setPrefix("DecodePlanTest: ");
+
+	uint64_t totalPackets = 0;
+	uint64_t totalValues = 0;
+	uint32_t mismatches = 0;
+	double perFrameSeconds = 0;
+	double decodePlanSeconds = 0;
+
+	std::cout << std::left << std::setw(28) << "Device description" << std::right << std::setw(10) << "Packets" << std::setw(10) << "Values" << std::setw(14) << "Old (ns)" << std::setw(14) << "Plan (ns)" << std::setw(10) << "Speedup" << std::setw(12) << "Mismatches" << std::endl;
+	for(auto& frames : deviceFrames)
+	{
+		bool oldFormat = false;
+		PHomegearDevice device = std::make_shared<HomegearDevice>(bl.get(), path + frames.file, oldFormat);
+		if(!device->loaded() || device->functions.empty())
+		{
+			std::cerr << "Could not load " << path << frames.file << std::endl;
+			return 1;
+		}
+		std::shared_ptr<ParameterIndex> parameterIndex = ParameterIndex::get(device);
+		DecodePlan* decodePlan = parameterIndex ? parameterIndex->getDecodePlan() : nullptr;
+		if(!decodePlan)
+		{
+			std::cerr << "No decode plan for " << frames.file << std::endl;
+			return 1;
+		}
+
+		std::vector<std::shared_ptr<MAXPacket>> packets;
+		for(auto& packet : frames.packets)
+		{
+			std::vector<uint8_t> packetBytes = bl->hf.getUBinary(packet);
+			packets.push_back(std::make_shared<MAXPacket>(packetBytes, false));
+		}
+
+		//Equivalence
+		uint32_t deviceMismatches = 0;
+		uint64_t deviceValues = 0;
+		DecodeResult result;
+		for(auto& packet : packets)
+		{
+			std::vector<FrameValues> frameValues;
+			int32_t lowBat = -1;
+			decodePerFrame(device, packet, frameValues, lowBat);
+			decodePlan->decode(peerAddress, packet, result);
+			Values expected = flatten(frameValues);
+			Values actual = flatten(*parameterIndex, result);
+			deviceValues += expected.size();
+			if(expected != actual || lowBat != result.lowBat)
+			{
+				std::cerr << "Mismatch for " << frames.file << ", packet " << packet->hexString() << std::endl;
+				std::cerr << "  Expected (LOWBAT " << lowBat << "): " << toString(expected) << std::endl;
+				std::cerr << "  Decoded (LOWBAT " << result.lowBat << "):  " << toString(actual) << std::endl;
+				deviceMismatches++;
+			}
+		}
+
+		//Speed
+		auto start = std::chrono::steady_clock::now();
+		for(uint32_t round = 0; round < rounds; round++)
+		{
+			for(auto& packet : packets)
+			{
+				std::vector<FrameValues> frameValues;
+				int32_t lowBat = -1;
+				decodePerFrame(device, packet, frameValues, lowBat);
+			}
+		}
+		double perFrame = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		start = std::chrono::steady_clock::now();
+		for(uint32_t round = 0; round < rounds; round++)
+		{
+			for(auto& packet : packets) decodePlan->decode(peerAddress, packet, result);
+		}
+		double plan = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		double decodes = (double)packets.size() * rounds;
+		std::cout << std::left << std::setw(28) << frames.file << std::right << std::setw(10) << packets.size() << std::setw(10) << deviceValues << std::fixed << std::setprecision(0)
+			<< std::setw(14) << perFrame * 1e9 / decodes << std::setw(14) << plan * 1e9 / decodes
+			<< std::setprecision(1) << std::setw(10) << perFrame / plan << std::setw(12) << deviceMismatches << std::endl;
+		totalPackets += packets.size();
+		totalValues += deviceValues;
+		mismatches += deviceMismatches;
+		perFrameSeconds += perFrame;
+		decodePlanSeconds += plan;
+	}
+
+	double decodes = (double)totalPackets * rounds;
+	std::cout << std::left << std::setw(28) << "Total" << std::right << std::setw(10) << totalPackets << std::setw(10) << totalValues << std::fixed << std::setprecision(0)
+		<< std::setw(14) << perFrameSeconds * 1e9 / decodes << std::setw(14) << decodePlanSeconds * 1e9 / decodes
+		<< std::setprecision(1) << std::setw(10) << perFrameSeconds / decodePlanSeconds << std::setw(12) << mismatches << std::endl;
+	return mismatches == 0 ? 0 : 1;
+}
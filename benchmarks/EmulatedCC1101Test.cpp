@@ -0,0 +1,247 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+//Drives the TI CC1101 driver against Cc1101Model. Random frames are put on air with model().receive() and the packets
+//raised by the driver are compared with them. Frames with CRC errors, recovery from an RX FIFO overflow and sending
+//with and without wake-on-radio burst are checked, too. Exits with 77 (skipped) when the module is built without SPI
+//interfaces.
+//Usage: EmulatedCC1101Test [frames]
+
+#include "../config.h"
+#include "GD.h"
+#include "MAXPacket.h"
+#include "PhysicalInterfaces/EmulatedCC1101.h"
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <thread>
+
+#ifdef SPIINTERFACES
+using namespace MAX;
+
+namespace
+{
+uint32_t failures = 0;
+
+void fail(const std::string& message)
+{
+	//Only the first failures are printed
+	if(failures++ < 20) std::cerr << message << std::endl;
+}
+
+class PacketList
+{
+public:
+	void add(std::shared_ptr<MAXPacket> packet)
+	{
+		{
+			std::lock_guard<std::mutex> packetsGuard(_packetsMutex);
+			_packets.push_back(packet);
+		}
+		_packetsConditionVariable.notify_all();
+	}
+
+	//Returns nullptr when no packet arrives within "timeout" milliseconds
+	std::shared_ptr<MAXPacket> wait(int32_t timeout)
+	{
+		std::unique_lock<std::mutex> packetsGuard(_packetsMutex);
+		if(!_packetsConditionVariable.wait_for(packetsGuard, std::chrono::milliseconds(timeout), [&] { return !_packets.empty(); })) return std::shared_ptr<MAXPacket>();
+		std::shared_ptr<MAXPacket> packet = _packets.front();
+		_packets.pop_front();
+		return packet;
+	}
+private:
+	std::mutex _packetsMutex;
+	std::condition_variable _packetsConditionVariable;
+	std::deque<std::shared_ptr<MAXPacket>> _packets;
+};
+
+class PacketSink : public BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink
+{
+public:
+	PacketList packets;
+
+	virtual bool onPacketReceived(std::string& senderID, std::shared_ptr<BaseLib::Systems::Packet> packet)
+	{
+		std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
+		if(!maxPacket) return false;
+		packets.add(maxPacket);
+		return true;
+	}
+};
+
+MAXPacket randomPacket(std::mt19937& random, uint32_t payloadSize, bool burst)
+{
+	std::uniform_int_distribution<uint32_t> bytes(0, 255);
+	std::uniform_int_distribution<int32_t> addresses(1, 0xFFFFFF);
+	std::vector<uint8_t> payload(payloadSize);
+	for(auto& byte : payload) byte = bytes(random);
+	return MAXPacket(bytes(random), bytes(random), bytes(random), addresses(random), addresses(random), payload, burst);
+}
+
+//Returns an empty string when the packets are equal
+std::string compare(MAXPacket& expected, const std::shared_ptr<MAXPacket>& actual)
+{
+	if(!actual) return "Nothing was decoded.";
+	if(expected.byteArray() == actual->byteArray()) return "";
+	return BaseLib::HelperFunctions::getHexString(actual->byteArray()) + " != " + BaseLib::HelperFunctions::getHexString(expected.byteArray());
+}
+
+//Same conversion as MAXPacket::import()
+int32_t rssiDevice(uint8_t rssi)
+{
+	int32_t value = rssi >= 128 ? ((rssi - 256) / 2) - 74 : (rssi / 2) - 74;
+	return value * -1;
+}
+
+bool waitForRx(Cc1101Model& model, int32_t timeout)
+{
+	int64_t endTime = BaseLib::HelperFunctions::getTime() + timeout;
+	while(BaseLib::HelperFunctions::getTime() < endTime)
+	{
+		if(model.state() == 0x10) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return model.state() == 0x10;
+}
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+#ifndef SPIINTERFACES
+	std::cout << "The module was built without SPI interfaces. Skipping." << std::endl;
+	return 77;
+#else
+	uint32_t frames = argc > 1 ? std::stoul(argv[1]) : 200;
+	if(frames == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [frames]" << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<BaseLib::SharedObjects> bl(new BaseLib::SharedObjects(false));
+	GD::bl = bl.get();
+	GD::out.init(bl.get());
+	GD::out.setPrefix("EmulatedCC1101Test: ");
+
+	std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings = std::make_shared<BaseLib::Systems::PhysicalInterfaceSettings>();
+	settings->id = "emulated";
+	settings->type = "cc1100emulated";
+	settings->interruptPin = 2;
+
+	PacketSink sink;
+	PacketList transmitted;
+	EmulatedCC1101 interface(settings);
+	Cc1101Model& model = interface.model();
+	model.setTransmitHandler([&](const std::vector<uint8_t>& packet)
+	{
+		std::vector<uint8_t> bytes(packet);
+		transmitted.add(std::make_shared<MAXPacket>(bytes, false));
+	});
+	BaseLib::PEventHandler eventHandler = interface.addEventHandler((BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink*)&sink);
+	interface.startListening();
+	if(!waitForRx(model, 2000))
+	{
+		std::cerr << "The driver didn't start receiving." << std::endl;
+		return 1;
+	}
+
+	std::mt19937 random(1);
+	std::uniform_int_distribution<uint32_t> rssiValues(0, 255);
+	//The driver drops the first packet after it started
+	MAXPacket warmUp = randomPacket(random, 4, false);
+	model.receive(warmUp.byteArray());
+	sink.packets.wait(500);
+	waitForRx(model, 1000);
+
+	//Length byte, header, payload, RSSI and LQI need to fit into the 64 byte FIFO
+	std::uniform_int_distribution<uint32_t> payloadSizes(0, 52);
+	for(uint32_t i = 0; i < frames; i++)
+	{
+		MAXPacket packet = randomPacket(random, payloadSizes(random), false);
+		uint8_t rssi = rssiValues(random);
+		if(!model.receive(packet.byteArray(), rssi))
+		{
+			fail("Frame " + std::to_string(i) + ": The chip is not receiving.");
+			waitForRx(model, 1000);
+			continue;
+		}
+		std::shared_ptr<MAXPacket> decoded = sink.packets.wait(1000);
+		std::string difference = compare(packet, decoded);
+		if(!difference.empty()) fail("Frame " + std::to_string(i) + ": " + difference);
+		else if(decoded->rssiDevice() != rssiDevice(rssi)) fail("Frame " + std::to_string(i) + ": RSSI " + std::to_string(decoded->rssiDevice()) + " != " + std::to_string(rssiDevice(rssi)));
+		if(!waitForRx(model, 1000)) fail("Frame " + std::to_string(i) + ": The driver didn't restart receiving.");
+	}
+
+	//Frames with CRC errors are dropped by the chip (CRC_AUTOFLUSH) and must not be raised
+	MAXPacket crcError = randomPacket(random, 10, false);
+	model.receive(crcError.byteArray(), 0x40, 0x20, false);
+	if(sink.packets.wait(300)) fail("A frame with CRC error was raised.");
+	if(!waitForRx(model, 1000)) fail("The driver didn't restart receiving after a CRC error.");
+
+	//A frame larger than the FIFO overflows it. The driver needs to flush the FIFO and continue receiving.
+	uint64_t rxOverflows = model.rxOverflows();
+	MAXPacket tooLarge = randomPacket(random, 60, false);
+	model.receive(tooLarge.byteArray());
+	if(model.rxOverflows() == rxOverflows) fail("The RX FIFO didn't overflow.");
+	if(sink.packets.wait(300)) fail("A frame that overflowed the FIFO was raised.");
+	if(!waitForRx(model, 1000)) fail("The driver didn't recover from the RX FIFO overflow.");
+	MAXPacket afterOverflow = randomPacket(random, 10, false);
+	model.receive(afterOverflow.byteArray());
+	std::string difference = compare(afterOverflow, sink.packets.wait(1000));
+	if(!difference.empty()) fail("Frame after the overflow: " + difference);
+	waitForRx(model, 1000);
+
+	//Sending. A burst sends the preamble for one second before the payload is written.
+	MAXPacket normal = randomPacket(random, 10, false);
+	interface.sendPacket(std::make_shared<MAXPacket>(normal));
+	difference = compare(normal, transmitted.wait(2000));
+	if(!difference.empty()) fail("Sending: " + difference);
+	if(!waitForRx(model, 1000)) fail("The driver didn't restart receiving after sending.");
+
+	MAXPacket burst = randomPacket(random, 10, true);
+	int64_t burstStart = BaseLib::HelperFunctions::getTime();
+	interface.sendPacket(std::make_shared<MAXPacket>(burst));
+	std::shared_ptr<MAXPacket> burstTransmitted = transmitted.wait(3000);
+	int64_t burstDuration = BaseLib::HelperFunctions::getTime() - burstStart;
+	difference = compare(burst, burstTransmitted);
+	if(!difference.empty()) fail("Sending a burst: " + difference);
+	else if(burstDuration < 900) fail("The burst payload was sent after " + std::to_string(burstDuration) + " ms instead of one second.");
+	if(!waitForRx(model, 1000)) fail("The driver didn't restart receiving after the burst.");
+
+	interface.stopListening();
+	interface.removeEventHandler(eventHandler);
+
+	std::cout << frames << " frames received, " << model.rxOverflows() << " RX FIFO overflows, " << model.accessCount() << " SPI accesses, " << failures << " failures." << std::endl;
+	return failures == 0 ? 0 : 1;
+#endif
+}
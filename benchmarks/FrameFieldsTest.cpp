@@ -0,0 +1,189 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+//Differential test of the generated frame fields. For every frame of the device description files it checks that
+//FrameFields::getFields() returns generated fields, i. e. that generateFrameFields.py and BaseLib read the frame the
+//same way, and that the generated extraction and insertion functions yield the same results as
+//MAXPacket::getPosition() and MAXPacket::setPosition() for random payloads and values. Payloads shorter than the
+//fields are included. Exits with 77 (skipped) when the module is built without generated frame fields.
+//Usage: FrameFieldsTest [device description directory] [iterations per field]
+
+#include "../config.h"
+#include "GD.h"
+#include "FrameFields.h"
+#include "MAXPacket.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#ifndef DEVICEDESCRIPTIONPATH
+#define DEVICEDESCRIPTIONPATH "misc/Device Description Files/"
+#endif
+
+using namespace MAX;
+using namespace BaseLib::DeviceDescription;
+
+namespace
+{
+uint32_t failures = 0;
+
+void fail(const std::string& file, const std::string& frame, const std::string& message)
+{
+	//Only the first failures are printed
+	if(failures++ < 20) std::cerr << file << ", frame " << frame << ": " << message << std::endl;
+}
+
+std::vector<uint8_t> randomBytes(std::mt19937& random, uint32_t size)
+{
+	std::uniform_int_distribution<uint32_t> bytes(0, 255);
+	std::vector<uint8_t> data(size);
+	for(auto& byte : data) byte = bytes(random);
+	return data;
+}
+
+void checkExtract(const std::string& file, const std::string& frame, FrameFields::Extract extract, double index, double size, uint32_t payloadSize, std::mt19937& random, uint32_t iterations)
+{
+	std::vector<uint8_t> generated;
+	for(uint32_t i = 0; i < iterations; i++)
+	{
+		//Every fourth payload is too short for the field
+		uint32_t currentPayloadSize = i % 4 == 0 ? i % payloadSize : payloadSize;
+		MAXPacket packet(0, 0, 0, 1, 2, randomBytes(random, currentPayloadSize), false);
+		extract(packet.payload(), generated);
+		std::vector<uint8_t> interpreted = packet.getPosition(index, size, -1);
+		if(generated != interpreted)
+		{
+			fail(file, frame, "Extraction of index " + std::to_string(index) + ", size " + std::to_string(size) + " differs for payload " + BaseLib::HelperFunctions::getHexString(packet.payload()) + ": " + BaseLib::HelperFunctions::getHexString(generated) + " != " + BaseLib::HelperFunctions::getHexString(interpreted));
+			return;
+		}
+	}
+}
+
+void checkInsert(const std::string& file, const std::string& frame, FrameFields::Insert insert, double index, double size, uint32_t payloadSize, std::mt19937& random, uint32_t iterations)
+{
+	uint32_t valueSize = std::max(1, (int32_t)std::ceil(size));
+	for(uint32_t i = 0; i < iterations; i++)
+	{
+		//Values shorter and longer than the field and empty values are included
+		std::vector<uint8_t> value = randomBytes(random, i % (valueSize + 2));
+		std::vector<uint8_t> value2 = value;
+		uint32_t currentPayloadSize = i % 4 == 0 ? i % payloadSize : payloadSize;
+		MAXPacket generated(0, 0, 0, 1, 2, randomBytes(random, currentPayloadSize), false);
+		MAXPacket interpreted(0, 0, 0, 1, 2, generated.payload(), false);
+		generated.setPosition(insert, value);
+		interpreted.setPosition(index, size, value2);
+		if(generated.payload() != interpreted.payload())
+		{
+			fail(file, frame, "Insertion of " + BaseLib::HelperFunctions::getHexString(value) + " at index " + std::to_string(index) + ", size " + std::to_string(size) + " differs: " + BaseLib::HelperFunctions::getHexString(generated.payload()) + " != " + BaseLib::HelperFunctions::getHexString(interpreted.payload()));
+			return;
+		}
+	}
+}
+}
+
+int main(int argc, char* argv[])
+{
+#ifndef GENERATEDFRAMEFIELDS
+	std::cout << "The module was built without generated frame fields. Skipping." << std::endl;
+	return 77;
+#else
+	std::string path = argc > 1 ? argv[1] : DEVICEDESCRIPTIONPATH;
+	if(!path.empty() && path.back() != '/') path.push_back('/');
+	uint32_t iterations = argc > 2 ? std::stoul(argv[2]) : 1000;
+	if(iterations == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [device description directory] [iterations per field]" << std::endl;
+		return 1;
+	}
+
+	std::unique_ptr<BaseLib::SharedObjects> bl(new BaseLib::SharedObjects(false));
+	GD::bl = bl.get();
+	GD::out.init(bl.get());
+	GD::out.setPrefix("FrameFieldsTest: ");
+
+	std::vector<std::string> files = bl->io.getFiles(path);
+	std::sort(files.begin(), files.end());
+	std::mt19937 random(1);
+	uint32_t frameCount = 0;
+	uint32_t fieldCount = 0;
+	for(auto& file : files)
+	{
+		if(file.size() < 5 || file.compare(file.size() - 4, 4, ".xml") != 0) continue;
+		bool oldFormat = false;
+		PHomegearDevice device = std::make_shared<HomegearDevice>(bl.get(), path + file, oldFormat);
+		if(!device->loaded())
+		{
+			fail(file, "", "Could not load the device description.");
+			continue;
+		}
+		for(auto& frameEntry : device->packetsById)
+		{
+			PPacket frame = frameEntry.second;
+			if(!frame || frame->binaryPayloads.empty()) continue;
+			frameCount++;
+			const FrameFields::Field* fields = FrameFields::getFields(device, frame);
+			if(!fields)
+			{
+				fail(file, frame->id, "No generated fields. The generator reads the frame differently.");
+				continue;
+			}
+			uint32_t payloadSize = 1;
+			for(auto& binaryPayload : frame->binaryPayloads)
+			{
+				payloadSize = std::max(payloadSize, (uint32_t)std::max(0, (int32_t)binaryPayload->index - 9 + std::max(1, (int32_t)std::ceil(binaryPayload->size))));
+				if(binaryPayload->index2 >= 9) payloadSize = std::max(payloadSize, (uint32_t)binaryPayload->index2 - 8);
+			}
+			payloadSize += 2;
+
+			uint32_t fieldIndex = 0;
+			for(auto& binaryPayload : frame->binaryPayloads)
+			{
+				const FrameFields::Field& field = fields[fieldIndex++];
+				fieldCount++;
+				//Only fields outside of the payload and partial byte fields larger than one byte are not generated
+				bool partial = std::lround(binaryPayload->index * 10) % 10 != 0 || binaryPayload->size < 0.8;
+				if(field.extract) checkExtract(file, frame->id, field.extract, binaryPayload->index, binaryPayload->size, payloadSize, random, iterations);
+				else if(binaryPayload->index >= 9 && (!partial || binaryPayload->size <= 1.0)) fail(file, frame->id, "No generated extraction function for " + binaryPayload->parameterId + ".");
+				if(field.extract2) checkExtract(file, frame->id, field.extract2, binaryPayload->index2, binaryPayload->size2, payloadSize, random, iterations);
+				if(field.insert) checkInsert(file, frame->id, field.insert, binaryPayload->index, binaryPayload->size, payloadSize, random, iterations);
+			}
+		}
+	}
+
+	std::cout << frameCount << " frames with " << fieldCount << " fields checked, " << failures << " failures." << std::endl;
+	if(frameCount == 0)
+	{
+		std::cerr << "No device descriptions found in " << path << std::endl;
+		return 1;
+	}
+	return failures == 0 ? 0 : 1;
+#endif
+}
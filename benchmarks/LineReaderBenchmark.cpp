@@ -0,0 +1,210 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+//Reads culfw lines from a fake CUL on a pseudo terminal like CUL::readFromDevice() does. "bytewise" is the loop used
+//before the LineReader: select() and a one byte read() until "\n". "linereader" drains everything available per
+//wakeup into a LineReader. The fake CUL writes the lines in bursts with a pause in between, like packets arriving over
+//the air. Prints lines per second, system calls per line and the CPU time of the reading thread. The exit code is 1
+//when lines were lost or corrupted.
+//Usage: LineReaderBenchmark [lines] [lines per burst] [pause between bursts in microseconds]
+
+#include "PhysicalInterfaces/LineReader.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <pty.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace MAX;
+
+namespace
+{
+class Result
+{
+public:
+	uint32_t lines = 0;
+	uint32_t corruptLines = 0;
+	uint64_t systemCalls = 0;
+	double seconds = 0;
+	double cpuSeconds = 0;
+};
+
+//A culfw MAX! line: "Z", the hex packet and the RSSI byte
+std::string createLine(uint32_t index)
+{
+	char line[64];
+	snprintf(line, sizeof(line), "Z0E%02X0242123456000001001928%08X\r\n", index & 0xFF, index);
+	return line;
+}
+
+double threadCpuSeconds()
+{
+	rusage usage{};
+	getrusage(RUSAGE_THREAD, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+bool waitForData(int32_t fileDescriptor, uint64_t& systemCalls)
+{
+	fd_set readFileDescriptor;
+	FD_ZERO(&readFileDescriptor);
+	FD_SET(fileDescriptor, &readFileDescriptor);
+	timeval timeout{2, 0};
+	systemCalls++;
+	return select(fileDescriptor + 1, &readFileDescriptor, nullptr, nullptr, &timeout) > 0;
+}
+
+void checkLine(std::string_view line, Result& result)
+{
+	if(line != createLine(result.lines)) result.corruptLines++;
+	result.lines++;
+}
+
+Result readBytewise(int32_t fileDescriptor, uint32_t lines)
+{
+	Result result;
+	std::string packet;
+	char localBuffer[1];
+	while(result.lines < lines)
+	{
+		if(!waitForData(fileDescriptor, result.systemCalls)) break;
+		result.systemCalls++;
+		if(read(fileDescriptor, localBuffer, 1) != 1) break;
+		packet.push_back(localBuffer[0]);
+		if(localBuffer[0] == '\n')
+		{
+			checkLine(packet, result);
+			packet.clear();
+		}
+	}
+	return result;
+}
+
+Result readLines(int32_t fileDescriptor, uint32_t lines)
+{
+	Result result;
+	LineReader lineReader(200);
+	std::string_view line;
+	while(result.lines < lines)
+	{
+		if(!waitForData(fileDescriptor, result.systemCalls)) break;
+		result.systemCalls++;
+		if(lineReader.read(fileDescriptor) <= 0) break;
+		while(lineReader.nextLine(line)) checkLine(line, result);
+	}
+	return result;
+}
+
+Result run(bool bytewise, uint32_t lines, uint32_t burstLines, std::chrono::microseconds pause)
+{
+	Result result;
+	int32_t master = -1;
+	int32_t slave = -1;
+	if(openpty(&master, &slave, nullptr, nullptr, nullptr) == -1)
+	{
+		std::cerr << "Could not open pseudo terminal: " << strerror(errno) << std::endl;
+		return result;
+	}
+	//The same settings as CUL::openDevice() uses for the real device
+	termios termios{};
+	tcgetattr(slave, &termios);
+	cfmakeraw(&termios);
+	cfsetispeed(&termios, B38400);
+	cfsetospeed(&termios, B38400);
+	tcsetattr(slave, TCSANOW, &termios);
+
+	std::thread fakeCul([&]()
+	{
+		std::string burst;
+		for(uint32_t i = 0; i < lines;)
+		{
+			burst.clear();
+			for(uint32_t j = 0; j < burstLines && i < lines; j++, i++) burst.append(createLine(i));
+			for(size_t written = 0; written < burst.size();)
+			{
+				ssize_t bytes = write(master, burst.data() + written, burst.size() - written);
+				if(bytes <= 0) return;
+				written += bytes;
+			}
+			if(pause.count() > 0) std::this_thread::sleep_for(pause);
+		}
+	});
+
+	auto start = std::chrono::steady_clock::now();
+	double cpuStart = threadCpuSeconds();
+	result = bytewise ? readBytewise(slave, lines) : readLines(slave, lines);
+	result.cpuSeconds = threadCpuSeconds() - cpuStart;
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	fakeCul.join();
+	close(slave);
+	close(master);
+	return result;
+}
+
+void print(const std::string& name, const Result& result)
+{
+	double lines = result.lines == 0 ? 1 : result.lines;
+	std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(0)
+		<< std::setw(12) << result.lines / result.seconds
+		<< std::setprecision(2) << std::setw(18) << result.systemCalls / lines
+		<< std::setprecision(1) << std::setw(20) << result.cpuSeconds * 1e6 / lines
+		<< std::setw(10) << result.lines << std::setw(10) << result.corruptLines << std::endl;
+}
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t lines = argc > 1 ? std::stoul(argv[1]) : 20000;
+	uint32_t burstLines = argc > 2 ? std::stoul(argv[2]) : 5;
+	std::chrono::microseconds pause(argc > 3 ? std::stoul(argv[3]) : 100);
+	if(lines == 0 || burstLines == 0)
+	{
+		std::cerr << "Usage: " << argv[0] << " [lines] [lines per burst] [pause between bursts in microseconds]" << std::endl;
+		return 1;
+	}
+
+	std::cout << lines << " lines, " << burstLines << " lines per burst, " << pause.count() << " us between bursts" << std::endl;
+	std::cout << std::left << std::setw(12) << "Reader" << std::right << std::setw(12) << "Lines/s" << std::setw(18) << "Syscalls/line" << std::setw(20) << "CPU us/line" << std::setw(10) << "Lines" << std::setw(10) << "Corrupt" << std::endl;
+	Result bytewise = run(true, lines, burstLines, pause);
+	print("bytewise", bytewise);
+	Result lineReader = run(false, lines, burstLines, pause);
+	print("linereader", lineReader);
+	bool complete = bytewise.lines == lines && lineReader.lines == lines && bytewise.corruptLines == 0 && lineReader.corruptLines == 0;
+	return complete ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# Generates type specialized frame field tables from the device description files.
+# Usage: generateFrameFields.py <device description directory> <output header>
+
+import os
+import re
+import sys
+import xml.etree.ElementTree as ElementTree
+
+
+def tenths(element, name, default):
+    child = element.find(name)
+    if child is None or not child.text:
+        return int(round(default * 10))
+    return int(round(float(child.text.strip()) * 10))
+
+
+def accessor(function, index10, size10):
+    if index10 < 90:
+        return "nullptr"
+    partial = index10 % 10 != 0 or size10 < 8
+    if partial and size10 > 10:
+        return "nullptr"
+    return "&%s<%d, %d>" % (function, index10, size10)
+
+
+def identifier(name):
+    return re.sub(r"[^A-Za-z0-9_]", "_", name)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.stderr.write("Usage: generateFrameFields.py <device description directory> <output header>\n")
+        return 1
+
+    lines = []
+    devices = []
+    for fileName in sorted(os.listdir(sys.argv[1])):
+        if not fileName.endswith(".xml"):
+            continue
+        root = ElementTree.parse(os.path.join(sys.argv[1], fileName)).getroot()
+        namespace = identifier(os.path.splitext(fileName)[0])
+        frames = []
+        lines.append("namespace %s" % namespace)
+        lines.append("{")
+        for packet in root.findall("./packets/packet"):
+            frameId = packet.get("id")
+            fields = []
+            for element in packet.findall("./binaryPayload/element"):
+                parameterId = element.findtext("parameterId", "").strip()
+                index10 = tenths(element, "index", 0)
+                size10 = tenths(element, "size", 1.0)
+                index2_10 = tenths(element, "index2", 0)
+                size2_10 = tenths(element, "size2", 0)
+                extract2 = accessor("extract", index2_10, size2_10) if index2_10 > 0 and size2_10 > 0 else "nullptr"
+                fields.append("{\"%s\", %d, %d, %d, %d, %s, %s, %s}" % (parameterId, index10, size10, index2_10, size2_10, accessor("extract", index10, size10), extract2, accessor("insert", index10, size10)))
+            if fields:
+                lines.append("constexpr Field %s[] = {" % identifier(frameId))
+                lines.append(",\n".join("\t" + field for field in fields))
+                lines.append("};")
+                frames.append("{\"%s\", %s, %d}" % (frameId, identifier(frameId), len(fields)))
+            else:
+                frames.append("{\"%s\", nullptr, 0}" % frameId)
+        lines.append("constexpr Frame frames[] = {")
+        lines.append(",\n".join("\t" + frame for frame in frames))
+        lines.append("};")
+        lines.append("}")
+        lines.append("")
+        for device in root.findall("./supportedDevices/device"):
+            devices.append("{\"%s\", %s::frames, %d}" % (device.get("id"), namespace, len(frames)))
+
+    with open(sys.argv[2], "w") as output:
+        output.write("//Generated by generateFrameFields.py from the device description files. Do not edit.\n\n")
+        output.write("#ifndef GENERATEDFRAMEFIELDS_H_\n#define GENERATEDFRAMEFIELDS_H_\n\n")
+        output.write("namespace MAX\n{\nnamespace FrameFields\n{\n")
+        output.write("\n".join(lines))
+        output.write("constexpr Device generatedDevices[] = {\n")
+        output.write(",\n".join("\t" + device for device in devices))
+        output.write("\n};\n")
+        output.write("constexpr uint32_t generatedDeviceCount = %d;\n" % len(devices))
+        output.write("}\n}\n\n#endif\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,225 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "AddressContextManager.h"
+#include "GD.h"
+
+namespace MAX
+{
+AddressContext::AddressContext(int32_t address)
+{
+	_address = address;
+}
+
+std::shared_ptr<PacketQueue> AddressContext::getQueue()
+{
+	std::shared_ptr<QueueData> queueData = std::atomic_load(&_queueData);
+	if(!queueData || !queueData->queue) return std::shared_ptr<PacketQueue>();
+	queueData->queue->keepAlive(); //Don't delete queue in the next second
+	return queueData->queue;
+}
+
+std::shared_ptr<MAXPacketInfo> AddressContext::getReceivedPacket()
+{
+	try
+	{
+		std::shared_ptr<MAXPacketInfo> info = std::atomic_load(&_receivedPacket);
+		//PacketManager deletes packets 2 seconds after they were received or answered
+		if(info && BaseLib::HelperFunctions::getTime() <= info->time + 2000) return info;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return std::shared_ptr<MAXPacketInfo>();
+}
+
+bool AddressContext::setReceivedPacket(std::shared_ptr<MAXPacket>& packet, int64_t time)
+{
+	try
+	{
+		//Only the receive path of this address writes here (see ReceiveDispatcher)
+		std::shared_ptr<MAXPacketInfo> info = std::atomic_load(&_receivedPacket);
+		if(info && info->packet->equals(packet) && time - info->time < 200) return true;
+		info = std::make_shared<MAXPacketInfo>();
+		info->packet = packet;
+		if(time > 0) info->time = time;
+		std::atomic_store(&_receivedPacket, info);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+std::shared_ptr<BaseLib::Systems::IPhysicalInterface> AddressContext::getPhysicalInterface()
+{
+	std::shared_ptr<QueueData> queueData = std::atomic_load(&_queueData);
+	if(queueData && queueData->queue) return queueData->queue->getPhysicalInterface();
+	std::shared_ptr<MAXPeer> peer = std::atomic_load(&_peer);
+	return peer ? peer->getPhysicalInterface() : GD::defaultPhysicalInterface;
+}
+
+AddressContextManager::AddressContextManager()
+{
+}
+
+AddressContextManager::~AddressContextManager()
+{
+	clear();
+}
+
+std::shared_ptr<AddressContext> AddressContextManager::get(int32_t address)
+{
+	try
+	{
+		std::shared_lock<std::shared_mutex> contextsGuard(_contextsMutex);
+		auto contextIterator = _contexts.find(address);
+		if(contextIterator != _contexts.end()) return contextIterator->second;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return std::shared_ptr<AddressContext>();
+}
+
+std::shared_ptr<AddressContext> AddressContextManager::getOrCreate(int32_t address)
+{
+	//_contextsMutex needs to be locked exclusively
+	std::shared_ptr<AddressContext>& context = _contexts[address];
+	if(!context) context = std::make_shared<AddressContext>(address);
+	return context;
+}
+
+void AddressContextManager::eraseIfUnused(int32_t address)
+{
+	//_contextsMutex needs to be locked exclusively
+	auto contextIterator = _contexts.find(address);
+	if(contextIterator == _contexts.end()) return;
+	if(!std::atomic_load(&contextIterator->second->_peer) && !std::atomic_load(&contextIterator->second->_queueData)) _contexts.erase(contextIterator);
+}
+
+void AddressContextManager::setPeer(int32_t address, std::shared_ptr<MAXPeer> peer)
+{
+	try
+	{
+		std::lock_guard<std::shared_mutex> contextsGuard(_contextsMutex);
+		std::shared_ptr<AddressContext> context = getOrCreate(address);
+		std::atomic_store(&context->_peer, peer);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void AddressContextManager::removePeer(int32_t address, uint64_t peerId)
+{
+	try
+	{
+		std::lock_guard<std::shared_mutex> contextsGuard(_contextsMutex);
+		auto contextIterator = _contexts.find(address);
+		if(contextIterator == _contexts.end()) return;
+		std::shared_ptr<MAXPeer> peer = std::atomic_load(&contextIterator->second->_peer);
+		if(!peer || peer->getID() != peerId) return;
+		std::atomic_store(&contextIterator->second->_peer, std::shared_ptr<MAXPeer>());
+		eraseIfUnused(address);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void AddressContextManager::setQueue(int32_t address, std::shared_ptr<QueueData> queueData)
+{
+	try
+	{
+		std::lock_guard<std::shared_mutex> contextsGuard(_contextsMutex);
+		std::shared_ptr<AddressContext> context = getOrCreate(address);
+		std::atomic_store(&context->_queueData, queueData);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void AddressContextManager::removeQueue(int32_t address, uint32_t queueId)
+{
+	try
+	{
+		std::lock_guard<std::shared_mutex> contextsGuard(_contextsMutex);
+		auto contextIterator = _contexts.find(address);
+		if(contextIterator == _contexts.end()) return;
+		std::shared_ptr<QueueData> queueData = std::atomic_load(&contextIterator->second->_queueData);
+		if(!queueData || queueData->id != queueId) return; //Queue was replaced in the meantime
+		std::atomic_store(&contextIterator->second->_queueData, std::shared_ptr<QueueData>());
+		eraseIfUnused(address);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void AddressContextManager::removeQueues()
+{
+	try
+	{
+		std::lock_guard<std::shared_mutex> contextsGuard(_contextsMutex);
+		for(auto i = _contexts.begin(); i != _contexts.end();)
+		{
+			std::atomic_store(&i->second->_queueData, std::shared_ptr<QueueData>());
+			if(!std::atomic_load(&i->second->_peer)) i = _contexts.erase(i);
+			else ++i;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void AddressContextManager::clear()
+{
+	try
+	{
+		std::lock_guard<std::shared_mutex> contextsGuard(_contextsMutex);
+		_contexts.clear();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+}
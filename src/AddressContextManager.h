@@ -0,0 +1,102 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef ADDRESSCONTEXTMANAGER_H_
+#define ADDRESSCONTEXTMANAGER_H_
+
+#include <homegear-base/BaseLib.h>
+#include "MAXPeer.h"
+#include "PacketManager.h"
+#include "PacketQueue.h"
+#include "QueueManager.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace MAX
+{
+//Everything the receive path needs to know about one radio address. Contexts only exist for addresses we have a peer
+//or a queue for, so packets of foreign devices don't allocate anything.
+class AddressContext
+{
+public:
+	AddressContext(int32_t address);
+	virtual ~AddressContext() {}
+
+	//Serializes enqueuing of pending queues for this address only
+	std::mutex enqueueMutex;
+
+	int32_t getAddress() { return _address; }
+	std::shared_ptr<MAXPeer> getPeer() { return std::atomic_load(&_peer); }
+	std::shared_ptr<QueueData> getQueueData() { return std::atomic_load(&_queueData); }
+	std::shared_ptr<PacketQueue> getQueue();
+	std::shared_ptr<BaseLib::Systems::IPhysicalInterface> getPhysicalInterface();
+
+	//The last packet received from the address like the central's received packet manager stores it for addresses
+	//without context. Returns nullptr when it is older than PacketManager keeps packets.
+	std::shared_ptr<MAXPacketInfo> getReceivedPacket();
+	//Returns true when the packet repeats the last one (see PacketManager::set())
+	bool setReceivedPacket(std::shared_ptr<MAXPacket>& packet, int64_t time);
+protected:
+	friend class AddressContextManager;
+
+	int32_t _address = 0;
+	std::shared_ptr<MAXPeer> _peer;
+	std::shared_ptr<QueueData> _queueData;
+	std::shared_ptr<MAXPacketInfo> _receivedPacket;
+};
+
+//Lookups only take a shared lock. Writes only happen when peers or queues are added or removed.
+class AddressContextManager
+{
+public:
+	AddressContextManager();
+	virtual ~AddressContextManager();
+
+	std::shared_ptr<AddressContext> get(int32_t address);
+	void setPeer(int32_t address, std::shared_ptr<MAXPeer> peer);
+	void removePeer(int32_t address, uint64_t peerId);
+	void setQueue(int32_t address, std::shared_ptr<QueueData> queueData);
+	void removeQueue(int32_t address, uint32_t queueId);
+	//Called when the queue manager is disposed, so no queue is returned afterwards
+	void removeQueues();
+	void clear();
+protected:
+	std::unordered_map<int32_t, std::shared_ptr<AddressContext>> _contexts;
+	std::shared_mutex _contextsMutex;
+
+	std::shared_ptr<AddressContext> getOrCreate(int32_t address);
+	void eraseIfUnused(int32_t address);
+};
+
+}
+#endif
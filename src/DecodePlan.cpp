@@ -0,0 +1,264 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "DecodePlan.h"
+#include "ParameterIndex.h"
+#include "GD.h"
+
+#include <algorithm>
+
+namespace MAX
+{
+DecodePlan::DecodePlan(BaseLib::DeviceDescription::PHomegearDevice device, ParameterIndex* parameterIndex) : _parameterIndex(parameterIndex)
+{
+	try
+	{
+		_framesByMessageType.fill(std::pair<uint32_t, uint32_t>(0, 0));
+		if(!device || !_parameterIndex || device->functions.empty()) return;
+		_lastChannel = device->functions.rbegin()->first;
+		if(_lastChannel >= (signed)maxChannels)
+		{
+			GD::out.printWarning("Warning: Device description has more than " + std::to_string(maxChannels) + " channels. Values of higher channels are not decoded.");
+			_lastChannel = maxChannels - 1;
+		}
+
+		std::vector<uint32_t> byName(_parameterIndex->size());
+		for(uint32_t i = 0; i < byName.size(); i++) byName[i] = i;
+		std::sort(byName.begin(), byName.end(), [&](uint32_t a, uint32_t b) { return _parameterIndex->getName(a) < _parameterIndex->getName(b); });
+		_ranks.resize(byName.size());
+		for(uint32_t i = 0; i < byName.size(); i++) _ranks[byName[i]] = i;
+
+		//packetsByMessageType is sorted by message type, so the frames of one type are contiguous
+		for(auto& frameEntry : device->packetsByMessageType)
+		{
+			BaseLib::DeviceDescription::PPacket frame = frameEntry.second;
+			if(!frame || frameEntry.first > 255) continue;
+
+			Frame compiledFrame;
+			compiledFrame.toCentral = frame->direction == BaseLib::DeviceDescription::Packet::Direction::Enum::toCentral;
+			compiledFrame.fromCentral = frame->direction == BaseLib::DeviceDescription::Packet::Direction::Enum::fromCentral;
+			compiledFrame.subtype = frame->subtype;
+			compiledFrame.length = frame->length;
+			compiledFrame.channelIndex = frame->channelIndex;
+			compiledFrame.channelIndexOffset = frame->channelIndexOffset;
+			if(frame->channelSize < 1.0) compiledFrame.channelMask = (0xFF >> (8 - std::lround(frame->channelSize * 10) % 10));
+			compiledFrame.fixedChannel = frame->channel;
+			compiledFrame.fieldsBegin = _fields.size();
+
+			const FrameFields::Field* generatedFields = FrameFields::getFields(device, frame);
+			uint32_t fieldIndex = 0;
+			for(auto& binaryPayload : frame->binaryPayloads)
+			{
+				Field field;
+				if(generatedFields)
+				{
+					field.extract = generatedFields[fieldIndex].extract;
+					field.extract2 = generatedFields[fieldIndex].extract2;
+				}
+				fieldIndex++;
+				field.hasPosition = binaryPayload->size > 0 && binaryPayload->index > 0;
+				field.index = binaryPayload->index;
+				field.size = binaryPayload->size;
+				field.constValue = binaryPayload->constValueInteger;
+				if(!field.hasPosition && field.constValue > -1) GD::bl->hf.memcpyBigEndian(field.constData, field.constValue);
+				if(binaryPayload->size2 > 0 && binaryPayload->index2 > 0 && binaryPayload->index2Offset > 0)
+				{
+					if(binaryPayload->size2 > 1.0) GD::out.printWarning("Warning: size2 of frame parameter is larger than 1 byte. That is not supported.");
+					else field.split = true;
+				}
+				field.index2 = binaryPayload->index2;
+				field.size2 = binaryPayload->size2;
+				field.index2Offset = binaryPayload->index2Offset;
+				field.lowBat = binaryPayload->parameterId == "LOWBAT";
+				field.targetsBegin = _targets.size();
+				for(auto& associatedVariable : frame->associatedVariables)
+				{
+					if(associatedVariable->physical->groupId != binaryPayload->parameterId) continue;
+					Target target;
+					target.parameterIndex = _parameterIndex->getIndex(associatedVariable->id);
+					if(target.parameterIndex == ParameterIndex::noParameter) continue;
+					target.type = associatedVariable->parent()->type();
+					_targets.push_back(target);
+				}
+				field.targetsEnd = _targets.size();
+				_fields.push_back(std::move(field));
+			}
+
+			compiledFrame.fieldsEnd = _fields.size();
+			std::pair<uint32_t, uint32_t>& range = _framesByMessageType[frameEntry.first];
+			if(range.first == range.second) range.first = _frames.size();
+			_frames.push_back(compiledFrame);
+			range.second = _frames.size();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void DecodePlan::addValue(DecodeResult& result, uint32_t frameBegin, uint32_t parameterIndex, uint32_t channel, const std::vector<uint8_t>& data)
+{
+	//A later field of the same frame overwrites the value
+	for(uint32_t i = frameBegin; i < result.size(); i++)
+	{
+		DecodedValue& value = result.at(i);
+		if(value.parameterIndex == parameterIndex && value.channel == channel)
+		{
+			value.value.assign(data.begin(), data.end());
+			return;
+		}
+	}
+	DecodedValue& value = result.add();
+	value.parameterIndex = parameterIndex;
+	value.channel = channel;
+	value.value.assign(data.begin(), data.end());
+}
+
+void DecodePlan::sortFrameValues(DecodeResult& result, uint32_t frameBegin)
+{
+	for(uint32_t i = frameBegin + 1; i < result.size(); i++)
+	{
+		for(uint32_t j = i; j > frameBegin; j--)
+		{
+			DecodedValue& previous = result.at(j - 1);
+			DecodedValue& value = result.at(j);
+			uint32_t previousRank = previous.parameterIndex < _ranks.size() ? _ranks[previous.parameterIndex] : previous.parameterIndex;
+			uint32_t rank = value.parameterIndex < _ranks.size() ? _ranks[value.parameterIndex] : value.parameterIndex;
+			if(previousRank < rank || (previousRank == rank && previous.channel <= value.channel)) break;
+			std::swap(previous, value);
+		}
+	}
+}
+
+void DecodePlan::decode(int32_t peerAddress, std::shared_ptr<MAXPacket>& packet, DecodeResult& result)
+{
+	try
+	{
+		result.clear();
+		const std::pair<uint32_t, uint32_t>& range = _framesByMessageType[packet->messageType()];
+		std::vector<uint8_t>& payload = packet->payload();
+		std::vector<uint8_t>& data = result.data;
+		std::vector<uint8_t>& data2 = result.data2;
+		for(uint32_t frameIndex = range.first; frameIndex < range.second; frameIndex++)
+		{
+			const Frame& frame = _frames[frameIndex];
+			if(frame.toCentral && packet->senderAddress() != peerAddress) continue;
+			if(frame.fromCentral && packet->destinationAddress() != peerAddress) continue;
+			if(payload.empty()) break;
+			if(frame.subtype > -1 && packet->messageSubtype() != frame.subtype) continue;
+			int32_t channel = -1;
+			if(frame.channelIndex >= 9 && (signed)payload.size() > (frame.channelIndex - 9)) channel = payload.at(frame.channelIndex - 9) - frame.channelIndexOffset;
+			if(channel > -1 && frame.channelMask != -1) channel &= frame.channelMask;
+			if(frame.fixedChannel > -1) channel = frame.fixedChannel;
+			if(frame.length > 0 && packet->length() != frame.length) continue;
+
+			uint32_t frameBegin = result.size();
+			uint64_t paramsetChannels = 0;
+			for(uint32_t fieldIndex = frame.fieldsBegin; fieldIndex < frame.fieldsEnd; fieldIndex++)
+			{
+				const Field& field = _fields[fieldIndex];
+				if(field.hasPosition)
+				{
+					if(((int32_t)field.index) - 9 >= (signed)payload.size()) continue;
+					if(field.extract) packet->getPosition(field.extract, data);
+					else packet->getPosition(field.index, field.size, -1, data);
+
+					if(field.constValue > -1)
+					{
+						int32_t intValue = 0;
+						GD::bl->hf.memcpyBigEndian(intValue, data);
+						if(intValue != field.constValue) break; else continue;
+					}
+
+					//Process split data
+					if(field.split && ((int32_t)field.index2) - 9 < (signed)payload.size())
+					{
+						if(field.extract2) packet->getPosition(field.extract2, data2);
+						else packet->getPosition(field.index2, field.size2, -1, data2);
+						int32_t byteIndex = field.index2Offset / 8;
+						int32_t bitIndex = field.index2Offset % 8;
+						if(data2.size() == 1)
+						{
+							if(byteIndex < (signed)data.size()) data.at(byteIndex) |= (data2.at(0) << bitIndex);
+							else
+							{
+								data2.insert(data2.end(), data.begin(), data.end());
+								data.swap(data2);
+							}
+						}
+					}
+				}
+				else if(field.constValue > -1) data.assign(field.constData.begin(), field.constData.end());
+				else continue;
+
+				if(field.lowBat) result.lowBat = (data.size() > 0 && data.at(0)) ? 1 : 0;
+
+				for(uint32_t targetIndex = field.targetsBegin; targetIndex < field.targetsEnd; targetIndex++)
+				{
+					const Target& target = _targets[targetIndex];
+					if(paramsetChannels == 0) //Fill paramsetChannels
+					{
+						int32_t startChannel = (channel < 0) ? 0 : channel;
+						//When fixedChannel is -2 (means '*') cycle through all channels
+						int32_t endChannel = startChannel;
+						if(frame.fixedChannel == -2)
+						{
+							startChannel = 0;
+							endChannel = _lastChannel;
+						}
+						if(endChannel >= (signed)maxChannels) continue;
+						for(int32_t l = startChannel; l <= endChannel; l++)
+						{
+							if(!_parameterIndex->inParameterSet(l, target.type, target.parameterIndex)) continue;
+							paramsetChannels |= (1ull << l);
+							addValue(result, frameBegin, target.parameterIndex, l, data);
+						}
+					}
+					else //Use paramsetChannels
+					{
+						for(uint32_t l = 0; l < maxChannels; l++)
+						{
+							if(!(paramsetChannels & (1ull << l))) continue;
+							if(!_parameterIndex->inParameterSet(l, target.type, target.parameterIndex)) continue;
+							addValue(result, frameBegin, target.parameterIndex, l, data);
+						}
+					}
+				}
+			}
+			if(result.size() - frameBegin > 1) sortFrameValues(result, frameBegin);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+}
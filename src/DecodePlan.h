@@ -0,0 +1,146 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef DECODEPLAN_H_
+#define DECODEPLAN_H_
+
+#include <homegear-base/BaseLib.h>
+#include "MAXPacket.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace MAX
+{
+class ParameterIndex;
+
+class DecodedValue
+{
+public:
+	//Interned parameter ID (see ParameterIndex)
+	uint32_t parameterIndex = 0;
+	uint32_t channel = 0;
+	std::vector<uint8_t> value;
+};
+
+//Output of DecodePlan::decode(). Elements and buffers are reused between calls, so once they have grown decoding does not
+//allocate anymore.
+class DecodeResult
+{
+public:
+	//-1 when the packet contains no LOWBAT field
+	int32_t lowBat = -1;
+	std::vector<uint8_t> data;
+	std::vector<uint8_t> data2;
+
+	uint32_t size() { return _size; }
+	DecodedValue& at(uint32_t index) { return _values.at(index); }
+	void clear() { _size = 0; lowBat = -1; }
+	DecodedValue& add() { if(_size == _values.size()) _values.emplace_back(); return _values[_size++]; }
+protected:
+	std::vector<DecodedValue> _values;
+	uint32_t _size = 0;
+};
+
+//The frames of one device description compiled to flat tables. Frames are looked up by message type, every frame
+//references a range of fields (the binary payloads) and every field a range of targets (the associated variables).
+//Values are returned frame by frame and within a frame ordered by parameter ID and channel, which is the order the
+//per-frame decoding passed them on.
+class DecodePlan
+{
+public:
+	DecodePlan(BaseLib::DeviceDescription::PHomegearDevice device, ParameterIndex* parameterIndex);
+	virtual ~DecodePlan() {}
+
+	void decode(int32_t peerAddress, std::shared_ptr<MAXPacket>& packet, DecodeResult& result);
+protected:
+	class Target
+	{
+	public:
+		uint32_t parameterIndex = 0;
+		BaseLib::DeviceDescription::ParameterGroup::Type::Enum type = BaseLib::DeviceDescription::ParameterGroup::Type::Enum::variables;
+	};
+
+	class Field
+	{
+	public:
+		bool hasPosition = false;
+		double index = 0;
+		double size = 0;
+		int32_t constValue = -1;
+		std::vector<uint8_t> constData;
+		bool split = false;
+		double index2 = 0;
+		double size2 = 0;
+		int32_t index2Offset = 0;
+		//Generated extraction functions (see FrameFields.h). nullptr when the interpreted path has to be used.
+		FrameFields::Extract extract = nullptr;
+		FrameFields::Extract extract2 = nullptr;
+		bool lowBat = false;
+		uint32_t targetsBegin = 0;
+		uint32_t targetsEnd = 0;
+	};
+
+	class Frame
+	{
+	public:
+		bool toCentral = false;
+		bool fromCentral = false;
+		int32_t subtype = -1;
+		int32_t length = 0;
+		int32_t channelIndex = -1;
+		int32_t channelIndexOffset = 0;
+		int32_t channelMask = -1;
+		int32_t fixedChannel = -1;
+		uint32_t fieldsBegin = 0;
+		uint32_t fieldsEnd = 0;
+	};
+
+	//Channels of one frame are tracked in a 64 bit mask
+	static const uint32_t maxChannels = 64;
+
+	ParameterIndex* _parameterIndex = nullptr;
+	int32_t _lastChannel = 0;
+	std::vector<Frame> _frames;
+	std::vector<Field> _fields;
+	std::vector<Target> _targets;
+	//Range in _frames for each message type
+	std::array<std::pair<uint32_t, uint32_t>, 256> _framesByMessageType;
+	//Position of every parameter index when sorted by parameter ID
+	std::vector<uint32_t> _ranks;
+
+	void addValue(DecodeResult& result, uint32_t frameBegin, uint32_t parameterIndex, uint32_t channel, const std::vector<uint8_t>& data);
+	//Orders the values of one frame by parameter ID and channel. Frames only yield a few values, so this is an insertion sort.
+	void sortFrameValues(DecodeResult& result, uint32_t frameBegin);
+};
+
+}
+
+#endif
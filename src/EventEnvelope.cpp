@@ -0,0 +1,192 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "EventEnvelope.h"
+#include "GD.h"
+
+namespace MAX
+{
+
+void EventEnvelope::init(uint64_t peerId, const std::string& serialNumber, std::shared_ptr<ParameterIndex> parameterIndex, uint32_t channelCount)
+{
+	try
+	{
+		_source = "device-" + std::to_string(peerId);
+		_serialNumber = serialNumber;
+		_addresses.clear();
+		_addresses.reserve(channelCount);
+		for(uint32_t i = 0; i < channelCount; i++)
+		{
+			_addresses.push_back(serialNumber + ":" + std::to_string(i));
+		}
+		_parameterIndex = parameterIndex;
+		_valueKeys.clear();
+		_valueKeys.resize(channelCount);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+std::string& EventEnvelope::address(uint32_t channel)
+{
+	if(channel < _addresses.size()) return _addresses[channel];
+	//Channels not known when the envelope was initialized
+	thread_local std::string address;
+	address = _serialNumber + ":" + std::to_string(channel);
+	return address;
+}
+
+std::shared_ptr<std::vector<std::string>> EventEnvelope::valueKeys(uint32_t channel, const std::vector<uint32_t>& parameterIndexes)
+{
+	try
+	{
+		if(!_parameterIndex) return std::make_shared<std::vector<std::string>>();
+		if(channel < _valueKeys.size())
+		{
+			std::shared_ptr<const ValueKeysList> list = std::atomic_load(&_valueKeys[channel]);
+			if(list)
+			{
+				for(auto& entry : *list)
+				{
+					if(entry.parameterIndexes == parameterIndexes) return entry.keys;
+				}
+			}
+		}
+
+		auto valueKeys = std::make_shared<std::vector<std::string>>();
+		valueKeys->reserve(parameterIndexes.size());
+		for(auto parameterIndex : parameterIndexes)
+		{
+			valueKeys->push_back(_parameterIndex->getName(parameterIndex));
+		}
+		if(channel >= _valueKeys.size()) return valueKeys; //Channels not known when the envelope was initialized
+
+		std::lock_guard<std::mutex> valueKeysGuard(_valueKeysMutex);
+		std::shared_ptr<const ValueKeysList> list = std::atomic_load(&_valueKeys[channel]);
+		if(list)
+		{
+			//Another thread might have added the list in the meantime
+			for(auto& entry : *list)
+			{
+				if(entry.parameterIndexes == parameterIndexes) return entry.keys;
+			}
+			if(list->size() >= _maxValueKeys) return valueKeys;
+		}
+		auto newList = list ? std::make_shared<ValueKeysList>(*list) : std::make_shared<ValueKeysList>();
+		newList->push_back(ValueKeys{parameterIndexes, valueKeys});
+		std::atomic_store(&_valueKeys[channel], std::shared_ptr<const ValueKeysList>(std::move(newList)));
+		return valueKeys;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return std::make_shared<std::vector<std::string>>();
+}
+
+void EventEnvelope::add(uint32_t channel, uint32_t parameterIndex, BaseLib::PVariable value)
+{
+	try
+	{
+		std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+		Pending& pending = _pending[channel];
+		if(pending.parameterIndexes.empty()) pending.due = BaseLib::HelperFunctions::getTime() + _coalescingWindow;
+		for(uint32_t i = 0; i < pending.parameterIndexes.size(); i++)
+		{
+			if(pending.parameterIndexes[i] == parameterIndex)
+			{
+				pending.values[i] = value;
+				return;
+			}
+		}
+		pending.parameterIndexes.push_back(parameterIndex);
+		pending.values.push_back(value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void EventEnvelope::takeDue(bool all, std::vector<Event>& events)
+{
+	try
+	{
+		std::vector<std::pair<uint32_t, Pending>> due;
+		{
+			std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+			if(_pending.empty()) return;
+			int64_t time = BaseLib::HelperFunctions::getTime();
+			for(auto i = _pending.begin(); i != _pending.end();)
+			{
+				if(all || i->second.due <= time)
+				{
+					due.emplace_back(i->first, std::move(i->second));
+					i = _pending.erase(i);
+				}
+				else ++i;
+			}
+		}
+		for(auto& pending : due)
+		{
+			Event event;
+			event.channel = pending.first;
+			event.valueKeys = valueKeys(pending.first, pending.second.parameterIndexes);
+			event.values = std::make_shared<std::vector<BaseLib::PVariable>>(std::move(pending.second.values));
+			events.push_back(std::move(event));
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+int64_t EventEnvelope::nextDue()
+{
+	try
+	{
+		std::lock_guard<std::mutex> pendingGuard(_pendingMutex);
+		int64_t nextDue = 0;
+		for(auto& pending : _pending)
+		{
+			if(nextDue == 0 || pending.second.due < nextDue) nextDue = pending.second.due;
+		}
+		return nextDue;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return 0;
+}
+
+}
@@ -0,0 +1,114 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef EVENTENVELOPE_H_
+#define EVENTENVELOPE_H_
+
+#include <homegear-base/BaseLib.h>
+#include "ParameterIndex.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace MAX
+{
+
+//Everything needed to raise value events of a peer without building strings: the preformatted event source and channel
+//addresses and interned value key lists. Optionally value updates arriving within the coalescing window are merged into
+//one event per channel.
+class EventEnvelope
+{
+public:
+	class Event
+	{
+	public:
+		uint32_t channel = 0;
+		std::shared_ptr<std::vector<std::string>> valueKeys;
+		std::shared_ptr<std::vector<BaseLib::PVariable>> values;
+	};
+
+	EventEnvelope() {}
+	virtual ~EventEnvelope() {}
+
+	//Not thread safe. Only call this before the peer is published to the central.
+	void init(uint64_t peerId, const std::string& serialNumber, std::shared_ptr<ParameterIndex> parameterIndex, uint32_t channelCount);
+	//Window in milliseconds. 0 disables coalescing.
+	void setCoalescingWindow(uint32_t coalescingWindow) { _coalescingWindow = coalescingWindow; }
+	bool coalescing() { return _coalescingWindow > 0; }
+
+	std::string& source() { return _source; }
+	std::string& address(uint32_t channel);
+	//Returns the same immutable vector for the same channel and parameter list. Events only read the key vectors. Lookups
+	//of cached lists don't lock.
+	std::shared_ptr<std::vector<std::string>> valueKeys(uint32_t channel, const std::vector<uint32_t>& parameterIndexes);
+
+	//Adds a value to the pending event of the channel. A newer value of the same parameter replaces the older one.
+	void add(uint32_t channel, uint32_t parameterIndex, BaseLib::PVariable value);
+	//Returns the events whose window has passed or all pending events when "all" is true.
+	void takeDue(bool all, std::vector<Event>& events);
+	//Time in milliseconds when the next pending event is due or 0
+	int64_t nextDue();
+protected:
+	class Pending
+	{
+	public:
+		int64_t due = 0;
+		std::vector<uint32_t> parameterIndexes;
+		std::vector<BaseLib::PVariable> values;
+	};
+
+	class ValueKeys
+	{
+	public:
+		std::vector<uint32_t> parameterIndexes;
+		std::shared_ptr<std::vector<std::string>> keys;
+	};
+	typedef std::vector<ValueKeys> ValueKeysList;
+
+	//Interned key lists are cached up to this number of distinct lists per channel.
+	static const uint32_t _maxValueKeys = 32;
+
+	std::string _source;
+	std::vector<std::string> _addresses;
+	std::string _serialNumber;
+	std::shared_ptr<ParameterIndex> _parameterIndex;
+	uint32_t _coalescingWindow = 0;
+	//Indexed by channel. Sized by init(). A list is never changed after it is stored. Additions replace it with a copy
+	//(std::atomic_store), so readers only need std::atomic_load. _valueKeysMutex serializes the additions.
+	std::mutex _valueKeysMutex;
+	std::vector<std::shared_ptr<const ValueKeysList>> _valueKeys;
+	std::mutex _pendingMutex;
+	std::map<uint32_t, Pending> _pending;
+};
+
+}
+#endif
@@ -0,0 +1,92 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "FrameFields.h"
+#include "../config.h"
+#include "GD.h"
+
+#include <cmath>
+
+#ifdef GENERATEDFRAMEFIELDS
+#include "GeneratedFrameFields.h"
+#endif
+
+namespace MAX
+{
+namespace FrameFields
+{
+const Field* getFields(BaseLib::DeviceDescription::PHomegearDevice& device, BaseLib::DeviceDescription::PPacket& frame)
+{
+#ifdef GENERATEDFRAMEFIELDS
+	try
+	{
+		if(!device || !frame) return nullptr;
+		//One device ID can be described by several files (e. g. for different firmware versions), so check all of them
+		for(auto& supportedDevice : device->supportedDevices)
+		{
+			for(uint32_t i = 0; i < generatedDeviceCount; i++)
+			{
+				if(supportedDevice->id != generatedDevices[i].id) continue;
+				for(uint32_t j = 0; j < generatedDevices[i].frameCount; j++)
+				{
+					const Frame& generatedFrame = generatedDevices[i].frames[j];
+					if(frame->id != generatedFrame.id) continue;
+					if(generatedFrame.fieldCount != frame->binaryPayloads.size()) break;
+					bool matches = true;
+					uint32_t fieldIndex = 0;
+					for(auto& binaryPayload : frame->binaryPayloads)
+					{
+						const Field& field = generatedFrame.fields[fieldIndex++];
+						if(binaryPayload->parameterId != field.parameterId ||
+							(uint32_t)std::lround(binaryPayload->index * 10) != field.index10 ||
+							(uint32_t)std::lround(binaryPayload->size * 10) != field.size10 ||
+							(uint32_t)std::lround(binaryPayload->index2 * 10) != field.index2_10 ||
+							(uint32_t)std::lround(binaryPayload->size2 * 10) != field.size2_10)
+						{
+							matches = false;
+							break;
+						}
+					}
+					if(matches) return generatedFrame.fields;
+					break;
+				}
+			}
+		}
+		GD::out.printDebug("Debug: No matching generated fields for frame " + frame->id + ". Using the interpreted path.");
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+#endif
+	return nullptr;
+}
+
+}
+}
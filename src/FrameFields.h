@@ -0,0 +1,150 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef FRAMEFIELDS_H_
+#define FRAMEFIELDS_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <array>
+#include <vector>
+
+namespace MAX
+{
+//Type specialized extraction and insertion of frame fields. index10 and size10 are the index and size from the device
+//description multiplied by 10 (e. g. 11.7 => 117). Indexes are counted from the start of the packet, so the payload
+//starts at 90. The functions behave exactly like MAXPacket::getPosition() and MAXPacket::setPosition() for indexes >= 9.
+namespace FrameFields
+{
+typedef void (*Extract)(const std::vector<uint8_t>& payload, std::vector<uint8_t>& result);
+typedef void (*Insert)(std::vector<uint8_t>& payload, std::vector<uint8_t>& value);
+
+constexpr std::array<uint8_t, 9> bitmask{0xFF, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F, 0x7F, 0xFF};
+
+template<uint32_t index10, uint32_t size10> void extract(const std::vector<uint8_t>& payload, std::vector<uint8_t>& result)
+{
+	static_assert(index10 >= 90, "Only payload fields are supported.");
+	constexpr uint32_t byteIndex = index10 / 10 - 9;
+	constexpr uint32_t bitIndex = index10 % 10;
+	constexpr bool partial = bitIndex != 0 || size10 < 8;
+	static_assert(!partial || size10 <= 10, "Partial byte fields can't be larger than one byte.");
+	result.clear();
+	if(byteIndex >= payload.size())
+	{
+		result.push_back(0);
+		return;
+	}
+	if(partial)
+	{
+		constexpr uint32_t bitSize = size10 > 8 ? 8 : size10;
+		result.push_back((payload[byteIndex] >> bitIndex) & bitmask[bitSize]);
+		return;
+	}
+	constexpr uint32_t bytes = size10 < 10 ? 1 : (size10 + 9) / 10;
+	constexpr uint32_t bitSize = (size10 % 10) > 8 ? 8 : size10 % 10;
+	result.push_back(payload[byteIndex] & bitmask[bitSize]);
+	for(uint32_t i = 1; i < bytes; i++)
+	{
+		result.push_back((byteIndex + i) >= payload.size() ? 0 : payload[byteIndex + i]);
+	}
+}
+
+template<uint32_t index10, uint32_t size10> void insert(std::vector<uint8_t>& payload, std::vector<uint8_t>& value)
+{
+	static_assert(index10 >= 90, "Only payload fields are supported.");
+	constexpr uint32_t byteIndex = index10 / 10 - 9;
+	constexpr uint32_t bitIndex = index10 % 10;
+	constexpr bool partial = bitIndex != 0 || size10 < 8;
+	static_assert(!partial || size10 <= 10, "Partial byte fields can't be larger than one byte.");
+	if(partial)
+	{
+		if(value.empty()) value.push_back(0);
+		if(payload.size() < byteIndex + 1) payload.resize(byteIndex + 1, 0);
+		payload[byteIndex] |= value.back() << bitIndex;
+		return;
+	}
+	constexpr uint32_t bytes = (size10 + 9) / 10;
+	if(payload.size() < byteIndex + bytes) payload.resize(byteIndex + bytes, 0);
+	if(value.empty()) return;
+	constexpr uint32_t bitSize = (size10 % 10) > 8 ? 8 : size10 % 10;
+	if(bytes <= value.size())
+	{
+		payload[byteIndex] |= value[0] & bitmask[bitSize];
+		for(uint32_t i = 1; i < bytes; i++)
+		{
+			payload[byteIndex + i] |= value[i];
+		}
+	}
+	else
+	{
+		uint32_t missingBytes = bytes - value.size();
+		for(uint32_t i = 0; i < value.size(); i++)
+		{
+			payload[byteIndex + missingBytes + i] |= value[i];
+		}
+	}
+}
+
+class Field
+{
+public:
+	const char* parameterId;
+	uint32_t index10;
+	uint32_t size10;
+	uint32_t index2_10;
+	uint32_t size2_10;
+	Extract extract;
+	Extract extract2;
+	Insert insert;
+};
+
+class Frame
+{
+public:
+	const char* id;
+	const Field* fields;
+	uint32_t fieldCount;
+};
+
+class Device
+{
+public:
+	const char* id;
+	const Frame* frames;
+	uint32_t frameCount;
+};
+
+//Returns the generated fields of a frame or nullptr. Generated fields are only returned when they match the frame of the
+//loaded device description exactly, so modified description files fall back to the interpreted path.
+const Field* getFields(BaseLib::DeviceDescription::PHomegearDevice& device, BaseLib::DeviceDescription::PPacket& frame);
+}
+
+}
+
+#endif
@@ -28,6 +28,7 @@
  */
 
 #include "GD.h"
+#include "PhysicalInterfaces/Reactor.h"
 
 namespace MAX
 {
@@ -36,5 +37,6 @@ namespace MAX
 	std::shared_ptr<Systems::FamilySettings> GD::settings;
 	std::map<std::string, std::shared_ptr<BaseLib::Systems::IPhysicalInterface>> GD::physicalInterfaces;
 	std::shared_ptr<BaseLib::Systems::IPhysicalInterface> GD::defaultPhysicalInterface;
+	std::shared_ptr<Reactor> GD::reactor;
 	BaseLib::Output GD::out;
 }
@@ -38,6 +38,7 @@
 
 namespace MAX
 {
+class Reactor;
 
 class GD
 {
@@ -49,6 +50,8 @@ public:
 	static std::shared_ptr<Systems::FamilySettings> settings;
 	static std::map<std::string, std::shared_ptr<BaseLib::Systems::IPhysicalInterface>> physicalInterfaces;
 	static std::shared_ptr<BaseLib::Systems::IPhysicalInterface> defaultPhysicalInterface;
+	//Only set when the interfaces share one epoll loop (setting "sharedReactor")
+	static std::shared_ptr<Reactor> reactor;
 	static BaseLib::Output out;
 private:
 	GD();
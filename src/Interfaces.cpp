@@ -31,9 +31,14 @@
 #include "GD.h"
 #include "PhysicalInterfaces/CUL.h"
 #include "PhysicalInterfaces/COC.h"
+#include "PhysicalInterfaces/CocGroup.h"
 #include "PhysicalInterfaces/Cunx.h"
 #include "PhysicalInterfaces/TICC1100.h"
+#include "PhysicalInterfaces/EmulatedCC1101.h"
 #include "PhysicalInterfaces/HomegearGateway.h"
+#include "PhysicalInterfaces/Reactor.h"
+
+#include <algorithm>
 
 namespace MAX
 {
@@ -51,17 +56,33 @@ void Interfaces::create()
 {
 	try
 	{
+		if(BaseLib::HelperFunctions::toLower(GD::settings->getString("sharedreactor")) == "true")
+		{
+			GD::reactor = std::make_shared<Reactor>();
+			GD::reactor->start();
+		}
+
+		bool groupStackedCoc = BaseLib::HelperFunctions::toLower(GD::settings->getString("groupstackedcoc")) == "true";
+		//Stacked COC modules by serial device
+		std::map<std::string, std::vector<std::pair<Systems::PPhysicalInterfaceSettings, std::shared_ptr<COC>>>> stackedCocs;
+
 		for(std::map<std::string, Systems::PPhysicalInterfaceSettings>::iterator i = _physicalInterfaceSettings.begin(); i != _physicalInterfaceSettings.end(); ++i)
 		{
 			std::shared_ptr<IMaxInterface> device;
 			if(!i->second) continue;
 			GD::out.printDebug("Debug: Creating physical device. Type defined in max.conf is: " + i->second->type);
 			if(i->second->type == "cul") device.reset(new CUL(i->second));
-			else if(i->second->type == "coc") device.reset(new COC(i->second));
+			else if(i->second->type == "coc")
+			{
+				std::shared_ptr<COC> coc = std::make_shared<COC>(i->second);
+				if(groupStackedCoc && i->second->stackPosition > 0) stackedCocs[i->second->device].emplace_back(i->second, coc);
+				device = coc;
+			}
 			else if(i->second->type == "cunx") device.reset(new Cunx(i->second));
             else if(i->second->type == "homegeargateway") device.reset(new HomegearGateway(i->second));
 #ifdef SPIINTERFACES
 			else if(i->second->type == "cc1100") device.reset(new TICC1100(i->second));
+			else if(i->second->type == "cc1100emulated") device.reset(new EmulatedCC1101(i->second));
 #endif
 			else GD::out.printError("Error: Unsupported physical device type: " + i->second->type);
 			if(device)
@@ -72,6 +93,11 @@ void Interfaces::create()
 				if(i->second->isDefault || !GD::defaultPhysicalInterface) GD::defaultPhysicalInterface = device;
 			}
 		}
+		for(auto& stack : stackedCocs)
+		{
+			if(stack.second.size() < 2) continue;
+			createCocGroup(stack.second);
+		}
 		if(!GD::defaultPhysicalInterface) GD::defaultPhysicalInterface = std::make_shared<IMaxInterface>(std::make_shared<BaseLib::Systems::PhysicalInterfaceSettings>());
 	}
 	catch(const std::exception& ex)
@@ -80,4 +106,36 @@ void Interfaces::create()
 	}
 }
 
+void Interfaces::createCocGroup(std::vector<std::pair<Systems::PPhysicalInterfaceSettings, std::shared_ptr<COC>>>& stack)
+{
+	try
+	{
+		std::sort(stack.begin(), stack.end(), [](const std::pair<Systems::PPhysicalInterfaceSettings, std::shared_ptr<COC>>& a, const std::pair<Systems::PPhysicalInterfaceSettings, std::shared_ptr<COC>>& b) { return a.first->stackPosition < b.first->stackPosition; });
+
+		//The group takes the id of the lowest module. The ids of the other modules are kept as aliases of the group, so
+		//peers assigned to them keep working.
+		Systems::PPhysicalInterfaceSettings settings = std::make_shared<Systems::PhysicalInterfaceSettings>(*stack.front().first);
+		std::vector<std::shared_ptr<COC>> members;
+		bool isDefault = false;
+		for(auto& member : stack)
+		{
+			members.push_back(member.second);
+			_physicalInterfaces.erase(member.first->id);
+			if(GD::defaultPhysicalInterface == member.second) isDefault = true;
+		}
+		std::shared_ptr<CocGroup> group = std::make_shared<CocGroup>(settings, members);
+		_physicalInterfaces[settings->id] = group;
+		for(auto& member : stack)
+		{
+			GD::physicalInterfaces[member.first->id] = group;
+		}
+		if(isDefault) GD::defaultPhysicalInterface = group;
+		GD::out.printInfo("Info: Combined " + std::to_string(members.size()) + " stacked COC modules on " + settings->device + " to interface \"" + settings->id + "\".");
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
 }
@@ -37,6 +37,8 @@ namespace MAX
 
 using namespace BaseLib;
 
+class COC;
+
 class Interfaces : public BaseLib::Systems::PhysicalInterfaces
 {
 public:
@@ -45,6 +47,8 @@ public:
 
 protected:
 	virtual void create();
+	//Replaces the COC modules stacked on one serial device by a CocGroup
+	void createCocGroup(std::vector<std::pair<Systems::PPhysicalInterfaceSettings, std::shared_ptr<COC>>>& stack);
 };
 
 }
@@ -30,7 +30,9 @@
 #include "MAX.h"
 #include "Interfaces.h"
 #include "MAXCentral.h"
+#include "ParameterIndex.h"
 #include "GD.h"
+#include "PhysicalInterfaces/Reactor.h"
 
 #include <iomanip>
 
@@ -63,8 +65,11 @@ void MAX::dispose()
 	if(_disposed) return;
 	DeviceFamily::dispose();
 
+	if(GD::reactor) GD::reactor->stop();
+	GD::reactor.reset();
 	GD::physicalInterfaces.clear();
 	GD::defaultPhysicalInterface.reset();
+	ParameterIndex::clearCache();
 }
 
 void MAX::createCentral()
@@ -30,6 +30,7 @@
 #include "MAXCentral.h"
 #include "MAXDeviceTypes.h"
 #include "GD.h"
+#include "PhysicalInterfaces/IMaxInterface.h"
 
 #include <iomanip>
 
@@ -53,6 +54,7 @@ void MAXCentral::dispose(bool wait) {
     _disposing = true;
     GD::out.printDebug("Removing device " + std::to_string(_deviceId) + " from physical device's event queue...");
     for (std::map<std::string, std::shared_ptr<IPhysicalInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i) {
+      if (i->second->getID() != i->first) continue; //Alias of a COC group
       //Just to make sure cycle through all physical devices. If event handler is not removed => segfault
       i->second->removeEventHandler(_physicalInterfaceEventhandlers[i->first]);
     }
@@ -62,11 +64,14 @@ void MAXCentral::dispose(bool wait) {
     _queueManager.dispose(false);
     _receivedPackets.dispose(false);
     _sentPackets.dispose(false);
+    _addressContexts.clear();
 
     _peersMutex.lock();
     for (std::unordered_map<int32_t, std::shared_ptr<BaseLib::Systems::Peer>>::const_iterator i = _peers.begin(); i != _peers.end(); ++i) {
       i->second->dispose();
     }
+    //Lookups after disposal must not find the disposed peers anymore
+    _peerIndex.clear();
     _peersMutex.unlock();
   }
   catch (const std::exception &ex) {
@@ -86,9 +91,19 @@ void MAXCentral::stopThreads() {
       _bl->threadManager.join(_pairingModeThread);
     }
 
-    _stopWorkerThread = true;
+    {
+      std::lock_guard<std::mutex> workerScheduleGuard(_workerScheduleMutex);
+      _stopWorkerThread = true;
+    }
+    _workerScheduleConditionVariable.notify_all();
     GD::out.printDebug("Debug: Waiting for worker thread of device " + std::to_string(_deviceId) + "...");
     _bl->threadManager.join(_workerThread);
+
+    GD::out.printDebug("Debug: Waiting for receive threads of device " + std::to_string(_deviceId) + "...");
+    _receiveDispatcher.stop();
+
+    GD::out.printDebug("Debug: Writing buffered parameters of device " + std::to_string(_deviceId) + "...");
+    _parameterWriteBuffer.stop();
   }
   catch (const std::exception &ex) {
     _peersMutex.unlock();
@@ -103,7 +118,9 @@ void MAXCentral::init() {
 
     _messages = std::shared_ptr<MAXMessages>(new MAXMessages());
 
-    _messageCounter[0] = 0; //Broadcast message counter
+    _queueManager.setAddressContexts(&_addressContexts);
+
+    _broadcastCounter.init(BaseLib::Math::getNumber(GD::settings->getString("messagecounterlease")), [this](uint8_t) { saveMessageCounters(); });
     _stopWorkerThread = false;
     _pairing = false;
     _stopPairingModeThread = false;
@@ -111,7 +128,29 @@ void MAXCentral::init() {
 
     setUpMAXMessages();
 
+    _localRpcMethods.emplace("getAllCachedValues", std::bind(&MAXCentral::getAllCachedValues, this, std::placeholders::_1, std::placeholders::_2));
+    _localRpcMethods.emplace("getPeersByServiceMessage", std::bind(&MAXCentral::getPeersByServiceMessage, this, std::placeholders::_1, std::placeholders::_2));
+
+    int32_t receiveThreads = BaseLib::Math::getNumber(GD::settings->getString("receivethreads"));
+    if (receiveThreads <= 0) receiveThreads = 2;
+    else if (receiveThreads > 16) receiveThreads = 16;
+    std::vector<std::string> interfaceIds;
+    interfaceIds.reserve(GD::physicalInterfaces.size());
+    for (std::map<std::string, std::shared_ptr<IPhysicalInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i) {
+      if (i->second->getID() != i->first) continue; //Alias of a COC group
+      interfaceIds.push_back(i->first);
+    }
+    _receiveDispatcher.start(this, receiveThreads, interfaceIds);
+
+    std::string parameterFlushIntervalSetting = GD::settings->getString("parameterflushinterval");
+    //0 disables the buffer, so only an unset or negative value falls back to the default
+    int32_t parameterFlushInterval = parameterFlushIntervalSetting.empty() ? 1000 : BaseLib::Math::getNumber(parameterFlushIntervalSetting);
+    if (parameterFlushInterval < 0) parameterFlushInterval = 1000;
+    int32_t parameterFlushSize = BaseLib::Math::getNumber(GD::settings->getString("parameterflushsize"));
+    _parameterWriteBuffer.start(this, parameterFlushInterval, parameterFlushSize <= 0 ? 200 : parameterFlushSize);
+
     for (std::map<std::string, std::shared_ptr<IPhysicalInterface>>::iterator i = GD::physicalInterfaces.begin(); i != GD::physicalInterfaces.end(); ++i) {
+      if (i->second->getID() != i->first) continue; //Alias of a COC group, packets are raised with the id of the group
       _physicalInterfaceEventhandlers[i->first] = i->second->addEventHandler((IPhysicalInterface::IPhysicalInterfaceEventSink *)this);
     }
 
@@ -145,43 +184,38 @@ void MAXCentral::setUpMAXMessages() {
 
 void MAXCentral::worker() {
   try {
-    std::chrono::milliseconds sleepingTime(10);
-    uint32_t counter = 0;
-    int32_t lastPeer;
-    lastPeer = 0;
-    //One loop on the Raspberry Pi takes about 30Âµs
     while (!_stopWorkerThread) {
       try {
-        std::this_thread::sleep_for(sleepingTime);
-        if (_stopWorkerThread) return;
-        if (counter > 10000) {
-          counter = 0;
-          _peersMutex.lock();
-          if (_peers.size() > 0) {
-            int32_t windowTimePerPeer = _bl->settings.workerThreadWindow() / _peers.size();
-            if (windowTimePerPeer > 2) windowTimePerPeer -= 2;
-            sleepingTime = std::chrono::milliseconds(windowTimePerPeer);
+        uint64_t peerId = 0;
+        {
+          std::unique_lock<std::mutex> workerScheduleGuard(_workerScheduleMutex);
+          if (_workerSchedule.empty()) {
+            _workerScheduleConditionVariable.wait(workerScheduleGuard, [&] { return _stopWorkerThread || !_workerSchedule.empty(); });
+            continue;
           }
-          _peersMutex.unlock();
-        }
-        _peersMutex.lock();
-        if (!_peers.empty()) {
-          if (!_peers.empty()) {
-            std::unordered_map<int32_t, std::shared_ptr<BaseLib::Systems::Peer>>::iterator nextPeer = _peers.find(lastPeer);
-            if (nextPeer != _peers.end()) {
-              nextPeer++;
-              if (nextPeer == _peers.end()) nextPeer = _peers.begin();
-            } else nextPeer = _peers.begin();
-            lastPeer = nextPeer->first;
+          std::pair<int64_t, uint64_t> next = _workerSchedule.top();
+          if (next.first > BaseLib::HelperFunctions::getTime()) {
+            _workerScheduleConditionVariable.wait_until(workerScheduleGuard, std::chrono::system_clock::time_point(std::chrono::milliseconds(next.first)));
+            continue;
           }
+          _workerSchedule.pop();
+          auto deadlineIterator = _workerDeadlines.find(next.second);
+          if (deadlineIterator == _workerDeadlines.end() || deadlineIterator->second != next.first) continue; //Rescheduled in the meantime
+          _workerDeadlines.erase(deadlineIterator);
+          peerId = next.second;
         }
-        _peersMutex.unlock();
-        std::shared_ptr<MAXPeer> peer(getPeer(lastPeer));
-        if (peer && !peer->deleting) peer->worker();
-        counter++;
+        if (_stopWorkerThread) return;
+
+        _peerIndex.reclaim();
+        std::shared_ptr<MAXPeer> peer(getPeer(peerId));
+        if (!peer || peer->deleting) continue;
+        peer->worker();
+        int64_t nextRun = peer->getNextWorkerRun();
+        //Make sure, a peer can never keep the thread busy
+        if (nextRun != 0 && nextRun <= BaseLib::HelperFunctions::getTime()) nextRun = BaseLib::HelperFunctions::getTime() + 1000;
+        scheduleWorker(peerId, nextRun);
       }
       catch (const std::exception &ex) {
-        _peersMutex.unlock();
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
       }
     }
@@ -191,12 +225,54 @@ void MAXCentral::worker() {
   }
 }
 
+void MAXCentral::scheduleWorker(uint64_t peerId, int64_t time) {
+  try {
+    bool notify = false;
+    {
+      //Without known deadline the peer is still visited regularly like the old round-robin loop did, so it never drops
+      //out of the schedule.
+      if (time == 0) {
+        int64_t interval = _bl->settings.workerThreadWindow();
+        time = BaseLib::HelperFunctions::getTime() + (interval > 0 ? interval : 3000);
+      }
+      std::lock_guard<std::mutex> workerScheduleGuard(_workerScheduleMutex);
+      auto deadlineIterator = _workerDeadlines.find(peerId);
+      if (deadlineIterator != _workerDeadlines.end() && deadlineIterator->second == time) return;
+      _workerDeadlines[peerId] = time;
+      notify = _workerSchedule.empty() || time < _workerSchedule.top().first;
+      _workerSchedule.emplace(time, peerId);
+
+      //Drop outdated entries when they start to dominate the heap
+      if (_workerSchedule.size() > 64 && _workerSchedule.size() > _workerDeadlines.size() * 4) {
+        std::vector<std::pair<int64_t, uint64_t>> deadlines;
+        deadlines.reserve(_workerDeadlines.size());
+        for (auto &deadline : _workerDeadlines) {
+          deadlines.emplace_back(deadline.second, deadline.first);
+        }
+        _workerSchedule = std::priority_queue<std::pair<int64_t, uint64_t>, std::vector<std::pair<int64_t, uint64_t>>, std::greater<std::pair<int64_t, uint64_t>>>(std::greater<std::pair<int64_t, uint64_t>>(), std::move(deadlines));
+      }
+    }
+    if (notify) _workerScheduleConditionVariable.notify_one();
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MAXCentral::unscheduleWorker(uint64_t peerId) {
+  try {
+    std::lock_guard<std::mutex> workerScheduleGuard(_workerScheduleMutex);
+    _workerDeadlines.erase(peerId);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 std::shared_ptr<IPhysicalInterface> MAXCentral::getPhysicalInterface(int32_t peerAddress) {
   try {
-    std::shared_ptr<PacketQueue> queue = _queueManager.get(peerAddress);
-    if (queue) return queue->getPhysicalInterface();
-    std::shared_ptr<MAXPeer> peer = getPeer(peerAddress);
-    return peer ? peer->getPhysicalInterface() : GD::defaultPhysicalInterface;
+    std::shared_ptr<AddressContext> context = _addressContexts.get(peerAddress);
+    return context ? context->getPhysicalInterface() : GD::defaultPhysicalInterface;
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -209,6 +285,19 @@ bool MAXCentral::onPacketReceived(std::string &senderID, std::shared_ptr<BaseLib
     if (_disposing) return false;
     std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
     if (!maxPacket) return false;
+    //Never block the listen thread of the interface with database or RPC work
+    if (_receiveDispatcher.dispatch(senderID, maxPacket)) return true;
+    return processReceivedPacket(senderID, maxPacket);
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+bool MAXCentral::processReceivedPacket(std::string &senderID, std::shared_ptr<MAXPacket> maxPacket) {
+  try {
+    if (_disposing || !maxPacket) return false;
     if (GD::bl->debugLevel >= 4)
       std::cout << BaseLib::HelperFunctions::getTimeString(maxPacket->getTimeReceived())
                 << " MAX packet received (" + senderID + (maxPacket->rssiDevice() ? ", RSSI: 0x" + BaseLib::HelperFunctions::getHexString(maxPacket->rssiDevice(), 2) : "") + "): " + maxPacket->hexString() << std::endl;
@@ -216,9 +305,12 @@ bool MAXCentral::onPacketReceived(std::string &senderID, std::shared_ptr<BaseLib
     {
       std::shared_ptr<MAXPeer> peer(getPeer(maxPacket->destinationAddress()));
       if (peer) {
-        if (senderID != peer->getPhysicalInterfaceID()) return true; //Packet we sent was received by another interface
+        //The interface ID of the peer might be an alias (e. g. of a COC in a group), senderID never is
+        std::shared_ptr<IPhysicalInterface> peerInterface = peer->getPhysicalInterface();
+        if (!peerInterface || senderID != peerInterface->getID()) return true; //Packet we sent was received by another interface
         GD::out.printWarning("Warning: Central address of packet to peer " + std::to_string(peer->getID()) + " was spoofed. Packet was: " + maxPacket->hexString());
         peer->serviceMessages->set("CENTRAL_ADDRESS_SPOOFED", 1, 0);
+        peer->indexServiceMessage(ServiceMessageIndex::centralAddressSpoofed, true);
         std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>{"CENTRAL_ADDRESS_SPOOFED"});
         std::shared_ptr<std::vector<PVariable>> values(new std::vector<PVariable>{std::make_shared<Variable>((int32_t)1)});
         std::string eventSource = "device-" + std::to_string(peer->getID());
@@ -228,33 +320,43 @@ bool MAXCentral::onPacketReceived(std::string &senderID, std::shared_ptr<BaseLib
       }
       return false;
     }
-    std::shared_ptr<IPhysicalInterface> physicalInterface = getPhysicalInterface(maxPacket->senderAddress());
+    //Resolve peer, queue and interface of the sender with one lookup
+    std::shared_ptr<AddressContext> context = _addressContexts.get(maxPacket->senderAddress());
+    std::shared_ptr<IPhysicalInterface> physicalInterface = context ? context->getPhysicalInterface() : GD::defaultPhysicalInterface;
     if (physicalInterface->getID() != senderID) return true;
 
     if (_pairing) {
       std::lock_guard<std::mutex> pairingInterfaceGuard(_pairingInterfaceMutex);
-      if (!_pairingInterface.empty() && senderID != _pairingInterface) return false;
+      if (!_pairingInterface.empty()) {
+        //Resolve aliases, so pairing works with the ID of any COC of a group
+        auto interfaceIterator = GD::physicalInterfaces.find(_pairingInterface);
+        std::string pairingInterfaceID = (interfaceIterator != GD::physicalInterfaces.end() && interfaceIterator->second) ? interfaceIterator->second->getID() : _pairingInterface;
+        if (senderID != pairingInterfaceID) return false;
+      }
     }
 
-    bool handled = false;
-    if (_receivedPackets.set(maxPacket->senderAddress(), maxPacket, maxPacket->getTimeReceived())) handled = true;
+    //Known addresses keep their last packet in the context, so only foreign devices need another lookup
+    bool handled = context ? context->setReceivedPacket(maxPacket, maxPacket->getTimeReceived()) : _receivedPackets.set(maxPacket->senderAddress(), maxPacket, maxPacket->getTimeReceived());
     std::shared_ptr<MAXMessage> message = _messages->find(maxPacket);
-    if (message && message->checkAccess(maxPacket, _queueManager.get(maxPacket->senderAddress()))) {
+    if (message && message->checkAccess(maxPacket, context ? context->getQueue() : std::shared_ptr<PacketQueue>())) {
       if (_bl->debugLevel >= 6) GD::out.printDebug("Debug: Device " + std::to_string(_deviceId) + ": Access granted for packet " + maxPacket->hexString());
       message->invokeMessageHandler(maxPacket);
       handled = true;
+      //The handler might have created the context (e. g. when pairing)
+      if (!context) context = _addressContexts.get(maxPacket->senderAddress());
     }
 
-    std::shared_ptr<MAXPeer> peer(getPeer(maxPacket->senderAddress()));
+    if (!context) return false;
+    std::shared_ptr<MAXPeer> peer(context->getPeer());
     if (!peer) return false;
-    std::shared_ptr<MAXPeer> team;
     if (handled) {
       //This block is not necessary for teams as teams will never have queues.
-      std::shared_ptr<PacketQueue> queue = _queueManager.get(maxPacket->senderAddress());
+      std::shared_ptr<PacketQueue> queue = context->getQueue();
       if (queue && queue->getQueueType() != PacketQueueType::PEER) {
         peer->setLastPacketReceived();
-        peer->serviceMessages->endUnreach();
+        peer->endUnreach();
         peer->setRSSIDevice(maxPacket->rssiDevice());
+        scheduleWorker(peer->getID(), peer->getNextWorkerRun());
         return true; //Packet is handled by queue. Don't check if queue is empty!
       }
     }
@@ -276,14 +378,14 @@ void MAXCentral::reset(uint64_t id) {
     //RESET
     std::vector<uint8_t> payload;
     payload.push_back(0);
-    std::shared_ptr<MAXPacket> resetPacket(new MAXPacket(_messageCounter[0], 0xF0, 0, _address, peer->getAddress(), payload, false));
+    std::shared_ptr<MAXPacket> resetPacket(new MAXPacket(_broadcastCounter.next(), 0xF0, 0, _address, peer->getAddress(), payload, false));
     pendingQueue->push(resetPacket);
     pendingQueue->push(_messages->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
-    _messageCounter[0]++; //Count resends in
 
     while (!peer->pendingQueues->empty()) peer->pendingQueues->pop();
     peer->pendingQueues->push(pendingQueue);
-    peer->serviceMessages->setConfigPending(true);
+    peer->setConfigPending(true);
+    scheduleWorker(peer->getID(), peer->getNextWorkerRun());
 
     if ((peer->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio) || (peer->getRXModes() & HomegearDevice::ReceiveModes::always)) {
       std::shared_ptr<PacketQueue> queue = _queueManager.createQueue(peer->getPhysicalInterface(), PacketQueueType::UNPAIRING, peer->getAddress());
@@ -298,24 +400,93 @@ void MAXCentral::reset(uint64_t id) {
 
 void MAXCentral::loadPeers() {
   try {
+    int64_t startTime = BaseLib::HelperFunctions::getTime();
+
+    //Stage 1: Fetch peers and their variables from the database. BaseLib has no query for the variables of several peers,
+    //so this still is one query per peer.
     std::shared_ptr<BaseLib::Database::DataTable> rows = _bl->db->getPeers(_deviceId);
+    std::vector<PeerLoadJob> jobs;
+    jobs.reserve(rows->size());
     for (BaseLib::Database::DataTable::iterator row = rows->begin(); row != rows->end(); ++row) {
-      int32_t peerID = row->second.at(0)->intValue;
-      GD::out.printMessage("Loading MAX! peer " + std::to_string(peerID));
-      int32_t address = row->second.at(2)->intValue;
-      std::shared_ptr<MAXPeer> peer(new MAXPeer(peerID, address, row->second.at(3)->textValue, _deviceId, this));
-      if (!peer->load(this)) continue;
-      if (!peer->getRpcDevice()) continue;
-      _peersMutex.lock();
-      _peers[peer->getAddress()] = peer;
-      if (!peer->getSerialNumber().empty()) _peersBySerial[peer->getSerialNumber()] = peer;
-      _peersById[peerID] = peer;
-      _peersMutex.unlock();
+      PeerLoadJob job;
+      job.id = row->second.at(0)->intValue;
+      job.address = row->second.at(2)->intValue;
+      job.serialNumber = row->second.at(3)->textValue;
+      job.variables = _bl->db->getPeerVariables(job.id);
+      jobs.push_back(std::move(job));
+    }
+    int64_t fetchTime = BaseLib::HelperFunctions::getTime();
+
+    //Stage 2: Build peers in parallel. Calls into BaseLib are serialized (see MAXPeer::load()), so mostly the indexing
+    //runs concurrently. Every finished peer is immediately reachable by the receive path.
+    std::atomic<uint32_t> nextJob(0);
+    uint32_t threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 1; //Unknown, the calling thread always builds
+    if (threadCount > 4) threadCount = 4;
+    if (threadCount > jobs.size() && !jobs.empty()) threadCount = jobs.size();
+    std::vector<std::thread> threads(threadCount > 1 ? threadCount - 1 : 0);
+    for (auto &thread : threads) {
+      try {
+        _bl->threadManager.start(thread, false, &MAXCentral::loadPeersThread, this, &jobs, &nextJob);
+      }
+      catch (const std::exception &ex) {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+      }
+    }
+    loadPeersThread(&jobs, &nextJob);
+    for (auto &thread : threads) {
+      _bl->threadManager.join(thread);
+    }
+    int64_t buildTime = BaseLib::HelperFunctions::getTime();
+
+    //Stage 3: Publish all peers at once
+    uint32_t loadedPeers = 0;
+    {
+      std::lock_guard<std::mutex> peersGuard(_peersMutex);
+      for (auto &job : jobs) {
+        if (!job.peer) continue;
+        _peers[job.peer->getAddress()] = job.peer;
+        if (!job.peer->getSerialNumber().empty()) _peersBySerial[job.peer->getSerialNumber()] = job.peer;
+        _peersById[job.peer->getID()] = job.peer;
+        loadedPeers++;
+      }
+      publishPeerIndex();
+    }
+    //The worker looks peers up in the published index, so peers can only be scheduled now. A deadline which is due
+    //earlier would otherwise be dropped.
+    for (auto &job : jobs) {
+      if (job.peer) scheduleWorker(job.peer->getID(), job.peer->getNextWorkerRun());
+    }
+    int64_t endTime = BaseLib::HelperFunctions::getTime();
+
+    GD::out.printInfo("Info: Loaded " + std::to_string(loadedPeers) + " of " + std::to_string(jobs.size()) + " MAX! peers in " + std::to_string(endTime - startTime) + " ms (database: " + std::to_string(fetchTime - startTime) + " ms, building with "
+                          + std::to_string(threadCount) + " threads: " + std::to_string(buildTime - fetchTime) + " ms, publishing: " + std::to_string(endTime - buildTime) + " ms).");
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void MAXCentral::loadPeersThread(std::vector<PeerLoadJob> *jobs, std::atomic<uint32_t> *nextJob) {
+  try {
+    for (uint32_t index = (*nextJob)++; index < jobs->size(); index = (*nextJob)++) {
+      try {
+        PeerLoadJob &job = jobs->at(index);
+        GD::out.printMessage("Loading MAX! peer " + std::to_string(job.id));
+        std::shared_ptr<MAXPeer> peer(new MAXPeer(job.id, job.address, job.serialNumber, _deviceId, this));
+        if (!peer->load(this, job.variables)) continue;
+        if (!peer->getRpcDevice()) continue;
+        job.variables.reset();
+        job.peer = peer;
+        _addressContexts.setPeer(peer->getAddress(), peer);
+      }
+      catch (const std::exception &ex) {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+      }
     }
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    _peersMutex.unlock();
   }
 }
 
@@ -351,11 +522,10 @@ void MAXCentral::saveMessageCounters() {
 void MAXCentral::serializeMessageCounters(std::vector<uint8_t> &encodedData) {
   try {
     BaseLib::BinaryEncoder encoder(_bl);
-    encoder.encodeInteger(encodedData, _messageCounter.size());
-    for (std::unordered_map<int32_t, uint8_t>::const_iterator i = _messageCounter.begin(); i != _messageCounter.end(); ++i) {
-      encoder.encodeInteger(encodedData, i->first);
-      encoder.encodeByte(encodedData, i->second);
-    }
+    //Only the broadcast counter (index 0) is used. The format is kept compatible with the former per-index map.
+    encoder.encodeInteger(encodedData, 1);
+    encoder.encodeInteger(encodedData, 0);
+    encoder.encodeByte(encodedData, _broadcastCounter.leaseEnd());
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -369,7 +539,8 @@ void MAXCentral::unserializeMessageCounters(std::shared_ptr<std::vector<char>> s
     uint32_t messageCounterSize = decoder.decodeInteger(*serializedData, position);
     for (uint32_t i = 0; i < messageCounterSize; i++) {
       int32_t index = decoder.decodeInteger(*serializedData, position);
-      _messageCounter[index] = decoder.decodeByte(*serializedData, position);
+      uint8_t leaseEnd = decoder.decodeByte(*serializedData, position);
+      if (index == 0) _broadcastCounter.load(leaseEnd);
     }
   }
   catch (const std::exception &ex) {
@@ -405,52 +576,42 @@ void MAXCentral::saveVariables() {
   }
 }
 
-std::shared_ptr<MAXPeer> MAXCentral::getPeer(int32_t address) {
+void MAXCentral::publishPeerIndex() {
   try {
-    _peersMutex.lock();
-    if (_peers.find(address) != _peers.end()) {
-      std::shared_ptr<MAXPeer> peer(std::dynamic_pointer_cast<MAXPeer>(_peers.at(address)));
-      _peersMutex.unlock();
-      return peer;
+    //_peersMutex needs to be locked, so snapshots are published in the same order the peer maps are changed.
+    std::unique_ptr<PeerIndex::Snapshot> snapshot(new PeerIndex::Snapshot());
+    snapshot->peersByAddress.reserve(_peers.size());
+    snapshot->peersById.reserve(_peersById.size());
+    snapshot->peersBySerial.reserve(_peersBySerial.size());
+    for (auto &peer : _peers) {
+      std::shared_ptr<MAXPeer> maxPeer(std::dynamic_pointer_cast<MAXPeer>(peer.second));
+      if (maxPeer) snapshot->peersByAddress.emplace(peer.first, maxPeer);
     }
+    for (auto &peer : _peersById) {
+      std::shared_ptr<MAXPeer> maxPeer(std::dynamic_pointer_cast<MAXPeer>(peer.second));
+      if (maxPeer) snapshot->peersById.emplace(peer.first, maxPeer);
+    }
+    for (auto &peer : _peersBySerial) {
+      std::shared_ptr<MAXPeer> maxPeer(std::dynamic_pointer_cast<MAXPeer>(peer.second));
+      if (maxPeer) snapshot->peersBySerial.emplace(peer.first, maxPeer);
+    }
+    _peerIndex.publish(std::move(snapshot));
   }
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
-  _peersMutex.unlock();
-  return std::shared_ptr<MAXPeer>();
+}
+
+std::shared_ptr<MAXPeer> MAXCentral::getPeer(int32_t address) {
+  return _peerIndex.get(address);
 }
 
 std::shared_ptr<MAXPeer> MAXCentral::getPeer(uint64_t id) {
-  try {
-    _peersMutex.lock();
-    if (_peersById.find(id) != _peersById.end()) {
-      std::shared_ptr<MAXPeer> peer(std::dynamic_pointer_cast<MAXPeer>(_peersById.at(id)));
-      _peersMutex.unlock();
-      return peer;
-    }
-  }
-  catch (const std::exception &ex) {
-    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-  }
-  _peersMutex.unlock();
-  return std::shared_ptr<MAXPeer>();
+  return _peerIndex.get(id);
 }
 
 std::shared_ptr<MAXPeer> MAXCentral::getPeer(std::string serialNumber) {
-  try {
-    _peersMutex.lock();
-    if (_peersBySerial.find(serialNumber) != _peersBySerial.end()) {
-      std::shared_ptr<MAXPeer> peer(std::dynamic_pointer_cast<MAXPeer>(_peersBySerial.at(serialNumber)));
-      _peersMutex.unlock();
-      return peer;
-    }
-  }
-  catch (const std::exception &ex) {
-    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-  }
-  _peersMutex.unlock();
-  return std::shared_ptr<MAXPeer>();
+  return _peerIndex.get(serialNumber);
 }
 
 void MAXCentral::deletePeer(uint64_t id) {
@@ -480,7 +641,10 @@ void MAXCentral::deletePeer(uint64_t id) {
       if (_peersBySerial.find(peer->getSerialNumber()) != _peersBySerial.end()) _peersBySerial.erase(peer->getSerialNumber());
       if (_peersById.find(id) != _peersById.end()) _peersById.erase(id);
       if (_peers.find(peer->getAddress()) != _peers.end()) _peers.erase(peer->getAddress());
+      publishPeerIndex();
     }
+    _addressContexts.removePeer(peer->getAddress(), id);
+    unscheduleWorker(id);
 
     int32_t i = 0;
     while (peer.use_count() > 1 && i < 600) {
@@ -489,6 +653,8 @@ void MAXCentral::deletePeer(uint64_t id) {
     }
     if (i == 600) GD::out.printError("Error: Peer deletion took too long.");
 
+    _parameterWriteBuffer.discard(id);
+    peer->removeFromServiceMessageIndex();
     peer->deleteFromDatabase();
 
     GD::out.printMessage("Removed peer " + std::to_string(peer->getID()));
@@ -512,6 +678,7 @@ std::string MAXCentral::handleCliCommand(std::string command) {
       stringStream << "peers select (ps)\tSelect a peer" << std::endl;
       stringStream << "peers setname (pn)\tName a peer" << std::endl;
       stringStream << "peers unpair (pup)\tUnpair a peer" << std::endl;
+      stringStream << "statistics (st)\t\tPrints runtime statistics" << std::endl;
       stringStream << "unselect (u)\t\tUnselect this device" << std::endl;
       return stringStream.str();
     }
@@ -818,6 +985,20 @@ std::string MAXCentral::handleCliCommand(std::string command) {
         _peersMutex.unlock();
         GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
       }
+    } else if (command == "statistics" || command == "st") {
+      stringStream << "Dropped received packets:\t" << _receiveDispatcher.droppedPackets() << std::endl;
+      stringStream << "Buffered parameters:\t\t" << _parameterWriteBuffer.queueDepth() << std::endl;
+      stringStream << "Parameter flush lag (ms):\t" << _parameterWriteBuffer.flushLag() << std::endl;
+      stringStream << "Flushed parameters:\t\t" << _parameterWriteBuffer.flushedParameters() << std::endl;
+      for (auto &physicalInterface : GD::physicalInterfaces) {
+        if (physicalInterface.second->getID() != physicalInterface.first) continue;
+        std::shared_ptr<IMaxInterface> maxInterface = std::dynamic_pointer_cast<IMaxInterface>(physicalInterface.second);
+        uint64_t frames = 0;
+        uint64_t systemCalls = 0;
+        if (!maxInterface || !maxInterface->getWriteStatistics(frames, systemCalls)) continue;
+        stringStream << "Write calls per frame (" << physicalInterface.first << "):\t" << std::fixed << std::setprecision(2) << (frames > 0 ? (double)systemCalls / frames : 0.0) << " (" << systemCalls << " calls, " << frames << " frames)" << std::endl;
+      }
+      return stringStream.str();
     } else return "Unknown command.\n";
   }
   catch (const std::exception &ex) {
@@ -840,7 +1021,10 @@ void MAXCentral::sendPacket(std::shared_ptr<IPhysicalInterface> physicalInterfac
       }
     }
     if (stealthy) _sentPackets.keepAlive(packet->destinationAddress());
-    packetInfo = _receivedPackets.getInfo(packet->destinationAddress());
+    std::shared_ptr<AddressContext> context = _addressContexts.get(packet->destinationAddress());
+    packetInfo = context ? context->getReceivedPacket() : std::shared_ptr<MAXPacketInfo>();
+    //The context might have been created after the packet was received (e. g. when pairing)
+    if (!packetInfo) packetInfo = _receivedPackets.getInfo(packet->destinationAddress());
     if (packetInfo) {
       int64_t time = BaseLib::HelperFunctions::getTime();
       int64_t timeDifference = time - packetInfo->time;
@@ -875,21 +1059,20 @@ void MAXCentral::sendOK(int32_t messageCounter, int32_t destinationAddress) {
 
 bool MAXCentral::enqueuePendingQueues(int32_t deviceAddress, bool wait) {
   try {
-    _enqueuePendingQueuesMutex.lock();
-    std::shared_ptr<MAXPeer> peer = getPeer(deviceAddress);
-    if (!peer || !peer->pendingQueues) {
-      _enqueuePendingQueuesMutex.unlock();
-      return true;
-    }
-    std::shared_ptr<PacketQueue> queue = _queueManager.get(deviceAddress);
-    if (!queue) queue = _queueManager.createQueue(peer->getPhysicalInterface(), PacketQueueType::DEFAULT, deviceAddress);
-    if (!queue) {
-      _enqueuePendingQueuesMutex.unlock();
-      return true;
+    std::shared_ptr<AddressContext> context = _addressContexts.get(deviceAddress);
+    if (!context) return true;
+    std::shared_ptr<MAXPeer> peer = context->getPeer();
+    if (!peer || !peer->pendingQueues) return true;
+
+    {
+      //Only enqueues for the same device need to be serialized. Devices waking up at the same time don't block each other.
+      std::lock_guard<std::mutex> enqueueGuard(context->enqueueMutex);
+      std::shared_ptr<PacketQueue> queue = context->getQueue();
+      if (!queue) queue = _queueManager.createQueue(peer->getPhysicalInterface(), PacketQueueType::DEFAULT, deviceAddress);
+      if (!queue) return true;
+      if (!queue->peer) queue->peer = peer;
+      if (queue->pendingQueuesEmpty()) queue->push(peer->pendingQueues);
     }
-    if (!queue->peer) queue->peer = peer;
-    if (queue->pendingQueuesEmpty()) queue->push(peer->pendingQueues);
-    _enqueuePendingQueuesMutex.unlock();
 
     if (wait) {
       int32_t waitIndex = 0;
@@ -907,7 +1090,6 @@ bool MAXCentral::enqueuePendingQueues(int32_t deviceAddress, bool wait) {
   catch (const std::exception &ex) {
     GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
-  _enqueuePendingQueuesMutex.unlock();
   return false;
 }
 
@@ -994,15 +1176,17 @@ void MAXCentral::handleAck(int32_t messageCounter, std::shared_ptr<MAXPacket> pa
         if (!peerExists(packet->senderAddress())) {
           if (!queue->peer) return;
           try {
-            _peersMutex.lock();
-            _peers[queue->peer->getAddress()] = queue->peer;
-            if (!queue->peer->getSerialNumber().empty()) _peersBySerial[queue->peer->getSerialNumber()] = queue->peer;
-            _peersMutex.unlock();
+            //initializeCentralConfig() indexes the values, which isn't thread safe, so the peer is only published when it is complete
             queue->peer->save(true, true, false);
             queue->peer->initializeCentralConfig();
             _peersMutex.lock();
+            _peers[queue->peer->getAddress()] = queue->peer;
+            if (!queue->peer->getSerialNumber().empty()) _peersBySerial[queue->peer->getSerialNumber()] = queue->peer;
             _peersById[queue->peer->getID()] = queue->peer;
+            publishPeerIndex();
             _peersMutex.unlock();
+            _addressContexts.setPeer(queue->peer->getAddress(), queue->peer);
+            scheduleWorker(queue->peer->getID(), queue->peer->getNextWorkerRun());
           }
           catch (const std::exception &ex) {
             _peersMutex.unlock();
@@ -1077,28 +1261,25 @@ void MAXCentral::handlePairingRequest(int32_t messageCounter, std::shared_ptr<MA
       //INCLUSION
       payload.push_back(0);
       payload.push_back(0);
-      std::shared_ptr<MAXPacket> configPacket(new MAXPacket(_messageCounter[0], 0x01, 0, _address, packet->senderAddress(), payload, peer->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+      std::shared_ptr<MAXPacket> configPacket(new MAXPacket(_broadcastCounter.next(), 0x01, 0, _address, packet->senderAddress(), payload, peer->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
       queue->push(configPacket);
       queue->push(_messages->find(0x02, -1, std::vector<std::pair<uint32_t, int32_t>>()));
       payload.clear();
-      _messageCounter[0]++;
 
       //WAKEUP
       /*payload.clear();
       payload.push_back(0);
       payload.push_back(0x3F);
-      configPacket = std::shared_ptr<MAXPacket>(new MAXPacket(_messageCounter[0], 0xF1, 0, _address, packet->senderAddress(), payload, false));
+      configPacket = std::shared_ptr<MAXPacket>(new MAXPacket(_broadcastCounter.next(), 0xF1, 0, _address, packet->senderAddress(), payload, false));
       queue->push(configPacket);
       queue->push(_messages->find(DIRECTIONIN, 0x02, -1, std::vector<std::pair<uint32_t, int32_t>>()));
-      payload.clear();
-      _messageCounter[0]++;*/
+      payload.clear();*/
 
       if (peer->getRpcDevice()->needsTime) {
         //TIME
-        queue->push(getTimePacket(_messageCounter[0], packet->senderAddress(), false));
+        queue->push(getTimePacket(_broadcastCounter.next(), packet->senderAddress(), false));
         queue->push(_messages->find(0x02, -1, std::vector<std::pair<uint32_t, int32_t>>()));
         payload.clear();
-        _messageCounter[0]++;
       }
     }
   }
@@ -1188,13 +1369,13 @@ PVariable MAXCentral::addLink(BaseLib::PRpcClientInfo clientInfo, uint64_t sende
     payload.push_back((receiver->getAddress() >> 8) & 0xFF);
     payload.push_back(receiver->getAddress() & 0xFF);
     payload.push_back(senderChannelIndex);
-    std::shared_ptr<MAXPacket> configPacket(new MAXPacket(_messageCounter[0], 0x20, 0, _address, sender->getAddress(), payload, sender->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+    std::shared_ptr<MAXPacket> configPacket(new MAXPacket(_broadcastCounter.next(), 0x20, 0, _address, sender->getAddress(), payload, sender->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
     pendingQueue->push(configPacket);
     pendingQueue->push(_messages->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
-    _messageCounter[0]++;
 
     sender->pendingQueues->push(pendingQueue);
-    sender->serviceMessages->setConfigPending(true);
+    sender->setConfigPending(true);
+    scheduleWorker(sender->getID(), sender->getNextWorkerRun());
 
     if ((sender->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio) || (sender->getRXModes() & HomegearDevice::ReceiveModes::always)) {
       std::shared_ptr<PacketQueue> queue = _queueManager.createQueue(sender->getPhysicalInterface(), PacketQueueType::CONFIG, sender->getAddress());
@@ -1209,7 +1390,7 @@ PVariable MAXCentral::addLink(BaseLib::PRpcClientInfo clientInfo, uint64_t sende
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       waitIndex++;
     }
-    if (!_queueManager.get(sender->getAddress())) sender->serviceMessages->setConfigPending(false);
+    if (!_queueManager.get(sender->getAddress())) sender->setConfigPending(false);
 
     pendingQueue.reset(new PacketQueue(receiver->getPhysicalInterface(), PacketQueueType::CONFIG));
     pendingQueue->noSending = true;
@@ -1221,13 +1402,13 @@ PVariable MAXCentral::addLink(BaseLib::PRpcClientInfo clientInfo, uint64_t sende
     payload.push_back((sender->getAddress() >> 8) & 0xFF);
     payload.push_back(sender->getAddress() & 0xFF);
     payload.push_back(receiverChannelIndex);
-    configPacket.reset(new MAXPacket(_messageCounter[0], 0x20, 0, _address, receiver->getAddress(), payload, receiver->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+    configPacket.reset(new MAXPacket(_broadcastCounter.next(), 0x20, 0, _address, receiver->getAddress(), payload, receiver->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
     pendingQueue->push(configPacket);
     pendingQueue->push(_messages->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
-    _messageCounter[0]++;
 
     receiver->pendingQueues->push(pendingQueue);
-    receiver->serviceMessages->setConfigPending(true);
+    receiver->setConfigPending(true);
+    scheduleWorker(receiver->getID(), receiver->getNextWorkerRun());
 
     if ((receiver->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio) || (receiver->getRXModes() & HomegearDevice::ReceiveModes::always)) {
       std::shared_ptr<PacketQueue> queue = _queueManager.createQueue(receiver->getPhysicalInterface(), PacketQueueType::CONFIG, receiver->getAddress());
@@ -1242,7 +1423,7 @@ PVariable MAXCentral::addLink(BaseLib::PRpcClientInfo clientInfo, uint64_t sende
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       waitIndex++;
     }
-    if (!_queueManager.get(receiver->getAddress())) receiver->serviceMessages->setConfigPending(false);
+    if (!_queueManager.get(receiver->getAddress())) receiver->setConfigPending(false);
 
     return PVariable(new Variable(VariableType::tVoid));
   }
@@ -1319,6 +1500,66 @@ std::shared_ptr<Variable> MAXCentral::getInstallMode(BaseLib::PRpcClientInfo cli
   return Variable::createError(-32500, "Unknown application error.");
 }
 
+PVariable MAXCentral::getAllCachedValues(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters) {
+  try {
+    std::vector<std::shared_ptr<MAXPeer>> peers;
+    if (!parameters->empty()) {
+      if (parameters->at(0)->type != VariableType::tArray) return Variable::createError(-1, "Parameter 1 is not of type Array.");
+      peers.reserve(parameters->at(0)->arrayValue->size());
+      for (auto &peerId : *parameters->at(0)->arrayValue) {
+        std::shared_ptr<MAXPeer> peer = getPeer((uint64_t)peerId->integerValue64);
+        if (!peer) return Variable::createError(-2, "Unknown device.");
+        peers.push_back(peer);
+      }
+    } else peers = _peerIndex.getAll();
+
+    PVariable values(new Variable(VariableType::tStruct));
+    for (auto &peer : peers) {
+      if (!clientInfo->acls->checkDeviceReadAccess(peer)) continue;
+      PVariable peerValues = peer->getCachedValues(clientInfo);
+      if (!peerValues || peerValues->errorStruct || peerValues->structValue->empty()) continue;
+      values->structValue->insert(StructElement(std::to_string(peer->getID()), peerValues));
+    }
+    return values;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
+PVariable MAXCentral::getPeersByServiceMessage(const BaseLib::PRpcClientInfo &clientInfo, const BaseLib::PArray &parameters) {
+  try {
+    if (parameters->empty()) return Variable::createError(-1, "Wrong parameter count.");
+    std::vector<PVariable> names;
+    if (parameters->at(0)->type == VariableType::tArray) names = *parameters->at(0)->arrayValue;
+    else if (parameters->at(0)->type == VariableType::tString) names.push_back(parameters->at(0));
+    else return Variable::createError(-1, "Parameter 1 is not of type String or Array.");
+    bool all = parameters->size() > 1 && parameters->at(1)->booleanValue;
+
+    uint32_t flagMask = 0;
+    for (auto &name : names) {
+      ServiceMessageIndex::Flag flag = ServiceMessageIndex::getFlag(name->stringValue);
+      if (flag == ServiceMessageIndex::flagCount) return Variable::createError(-5, "Service message " + name->stringValue + " is not indexed.");
+      flagMask |= 1u << flag;
+    }
+
+    std::vector<uint64_t> peerIds = _serviceMessageIndex.get(flagMask, all);
+    PVariable result(new Variable(VariableType::tArray));
+    result->arrayValue->reserve(peerIds.size());
+    for (auto peerId : peerIds) {
+      std::shared_ptr<MAXPeer> peer = getPeer(peerId);
+      if (!peer || !clientInfo->acls->checkDeviceReadAccess(peer)) continue;
+      result->arrayValue->push_back(std::make_shared<Variable>((uint32_t)peerId));
+    }
+    return result;
+  }
+  catch (const std::exception &ex) {
+    GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return Variable::createError(-32500, "Unknown application error.");
+}
+
 PVariable MAXCentral::putParamset(BaseLib::PRpcClientInfo clientInfo, std::string serialNumber, int32_t channel, ParameterGroup::Type::Enum type, std::string remoteSerialNumber, int32_t remoteChannel, PVariable paramset) {
   try {
     std::shared_ptr<MAXPeer> peer(getPeer(serialNumber));
@@ -1337,7 +1578,7 @@ PVariable MAXCentral::putParamset(BaseLib::PRpcClientInfo clientInfo, std::strin
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       waitIndex++;
     }
-    if (!_queueManager.get(peer->getAddress())) peer->serviceMessages->setConfigPending(false);
+    if (!_queueManager.get(peer->getAddress())) peer->setConfigPending(false);
     return result;
   }
   catch (const std::exception &ex) {
@@ -1357,7 +1598,7 @@ PVariable MAXCentral::putParamset(BaseLib::PRpcClientInfo clientInfo, uint64_t p
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       waitIndex++;
     }
-    if (!_queueManager.get(peer->getAddress())) peer->serviceMessages->setConfigPending(false);
+    if (!_queueManager.get(peer->getAddress())) peer->setConfigPending(false);
     return result;
   }
   catch (const std::exception &ex) {
@@ -1412,13 +1653,13 @@ PVariable MAXCentral::removeLink(BaseLib::PRpcClientInfo clientInfo, uint64_t se
     payload.push_back((receiver->getAddress() >> 8) & 0xFF);
     payload.push_back(receiver->getAddress() & 0xFF);
     payload.push_back(senderChannelIndex);
-    std::shared_ptr<MAXPacket> configPacket(new MAXPacket(_messageCounter[0], 0x21, 0, _address, sender->getAddress(), payload, sender->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+    std::shared_ptr<MAXPacket> configPacket(new MAXPacket(_broadcastCounter.next(), 0x21, 0, _address, sender->getAddress(), payload, sender->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
     pendingQueue->push(configPacket);
     pendingQueue->push(_messages->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
-    _messageCounter[0]++;
 
     sender->pendingQueues->push(pendingQueue);
-    sender->serviceMessages->setConfigPending(true);
+    sender->setConfigPending(true);
+    scheduleWorker(sender->getID(), sender->getNextWorkerRun());
 
     if ((sender->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio) || (sender->getRXModes() & HomegearDevice::ReceiveModes::always)) {
       std::shared_ptr<PacketQueue> queue = _queueManager.createQueue(sender->getPhysicalInterface(), PacketQueueType::CONFIG, sender->getAddress());
@@ -1433,7 +1674,7 @@ PVariable MAXCentral::removeLink(BaseLib::PRpcClientInfo clientInfo, uint64_t se
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       waitIndex++;
     }
-    if (!_queueManager.get(sender->getAddress())) sender->serviceMessages->setConfigPending(false);
+    if (!_queueManager.get(sender->getAddress())) sender->setConfigPending(false);
 
     pendingQueue.reset(new PacketQueue(receiver->getPhysicalInterface(), PacketQueueType::CONFIG));
     pendingQueue->noSending = true;
@@ -1444,13 +1685,13 @@ PVariable MAXCentral::removeLink(BaseLib::PRpcClientInfo clientInfo, uint64_t se
     payload.push_back((sender->getAddress() >> 8) & 0xFF);
     payload.push_back(sender->getAddress() & 0xFF);
     payload.push_back(receiverChannelIndex);
-    configPacket.reset(new MAXPacket(_messageCounter[0], 0x21, 0, _address, receiver->getAddress(), payload, receiver->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+    configPacket.reset(new MAXPacket(_broadcastCounter.next(), 0x21, 0, _address, receiver->getAddress(), payload, receiver->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
     pendingQueue->push(configPacket);
     pendingQueue->push(_messages->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
-    _messageCounter[0]++;
 
     receiver->pendingQueues->push(pendingQueue);
-    receiver->serviceMessages->setConfigPending(true);
+    receiver->setConfigPending(true);
+    scheduleWorker(receiver->getID(), receiver->getNextWorkerRun());
 
     if ((receiver->getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio) || (receiver->getRXModes() & HomegearDevice::ReceiveModes::always)) {
       std::shared_ptr<PacketQueue> queue = _queueManager.createQueue(receiver->getPhysicalInterface(), PacketQueueType::CONFIG, receiver->getAddress());
@@ -1465,7 +1706,7 @@ PVariable MAXCentral::removeLink(BaseLib::PRpcClientInfo clientInfo, uint64_t se
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
       waitIndex++;
     }
-    if (!_queueManager.get(receiver->getAddress())) receiver->serviceMessages->setConfigPending(false);
+    if (!_queueManager.get(receiver->getAddress())) receiver->setConfigPending(false);
 
     return std::make_shared<Variable>(VariableType::tVoid);
   }
@@ -36,9 +36,18 @@
 #include "MAXMessages.h"
 #include "QueueManager.h"
 #include "PacketManager.h"
-
+#include "AddressContextManager.h"
+#include "PeerIndex.h"
+#include "ReceiveDispatcher.h"
+#include "ParameterWriteBuffer.h"
+#include "MessageCounter.h"
+#include "ServiceMessageIndex.h"
+
+#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <queue>
 #include <string>
 
 namespace MAX
@@ -59,7 +68,7 @@ public:
 	virtual void stopThreads();
 	virtual void dispose(bool wait = true);
 
-	std::unordered_map<int32_t, uint8_t>* messageCounter() { return &_messageCounter; }
+	MessageCounter* broadcastCounter() { return &_broadcastCounter; }
 	static bool isSwitch(uint32_t type);
 
 	std::shared_ptr<MAXPeer> getPeer(int32_t address);
@@ -79,9 +88,15 @@ public:
 	virtual void savePeers(bool full);
 
 	virtual bool onPacketReceived(std::string& senderID, std::shared_ptr<BaseLib::Systems::Packet> packet);
+	bool processReceivedPacket(std::string& senderID, std::shared_ptr<MAXPacket> maxPacket);
 	virtual std::string handleCliCommand(std::string command);
 	virtual uint64_t getPeerIdFromSerial(std::string& serialNumber) { std::shared_ptr<MAXPeer> peer = getPeer(serialNumber); if(peer) return peer->getID(); else return 0; }
 	virtual bool enqueuePendingQueues(int32_t deviceAddress, bool wait = false);
+	//Runs the worker of the peer at "time". 0 means no known deadline, the peer is visited after the worker thread window.
+	void scheduleWorker(uint64_t peerId, int64_t time);
+	void unscheduleWorker(uint64_t peerId);
+	ParameterWriteBuffer& getParameterWriteBuffer() { return _parameterWriteBuffer; }
+	ServiceMessageIndex& getServiceMessageIndex() { return _serviceMessageIndex; }
 	void reset(uint64_t id);
 
 	virtual void sendPacket(std::shared_ptr<BaseLib::Systems::IPhysicalInterface> physicalInterface, std::shared_ptr<MAXPacket> packet, bool stealthy = false);
@@ -96,6 +111,10 @@ public:
 	virtual PVariable deleteDevice(BaseLib::PRpcClientInfo clientInfo, std::string serialNumber, int32_t flags);
 	virtual PVariable deleteDevice(BaseLib::PRpcClientInfo clientInfo, uint64_t peerID, int32_t flags);
 	virtual PVariable getInstallMode(BaseLib::PRpcClientInfo clientInfo);
+	//Family method "getAllCachedValues": Values of all (or the given) peers from the peers' converted value caches
+	PVariable getAllCachedValues(const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters);
+	//Family method "getPeersByServiceMessage": IDs of the peers having one or all of the given service messages set
+	PVariable getPeersByServiceMessage(const BaseLib::PRpcClientInfo& clientInfo, const BaseLib::PArray& parameters);
 	virtual PVariable putParamset(BaseLib::PRpcClientInfo clientInfo, std::string serialNumber, int32_t channel, ParameterGroup::Type::Enum type, std::string remoteSerialNumber, int32_t remoteChannel, PVariable paramset);
 	virtual PVariable putParamset(BaseLib::PRpcClientInfo clientInfo, uint64_t peerID, int32_t channel, ParameterGroup::Type::Enum type, uint64_t remoteID, int32_t remoteChannel, PVariable paramset, bool checkAcls);
 	virtual PVariable removeLink(BaseLib::PRpcClientInfo clientInfo, std::string senderSerialNumber, int32_t senderChannel, std::string receiverSerialNumber, int32_t receiverChannel);
@@ -105,12 +124,22 @@ public:
 protected:
 	//In table variables
 	int32_t _centralAddress = 0;
-	std::unordered_map<int32_t, uint8_t> _messageCounter;
+	MessageCounter _broadcastCounter;
 	//End
 
 	std::atomic_bool _stopWorkerThread;
 	std::thread _workerThread;
-
+	//Min heap of peer worker deadlines. Entries not matching _workerDeadlines are outdated and skipped.
+	std::mutex _workerScheduleMutex;
+	std::condition_variable _workerScheduleConditionVariable;
+	std::priority_queue<std::pair<int64_t, uint64_t>, std::vector<std::pair<int64_t, uint64_t>>, std::greater<std::pair<int64_t, uint64_t>>> _workerSchedule;
+	std::unordered_map<uint64_t, int64_t> _workerDeadlines;
+
+	AddressContextManager _addressContexts;
+	PeerIndex _peerIndex;
+	ReceiveDispatcher _receiveDispatcher;
+	ParameterWriteBuffer _parameterWriteBuffer;
+	ServiceMessageIndex _serviceMessageIndex;
 	QueueManager _queueManager;
 	PacketManager _receivedPackets;
 	PacketManager _sentPackets;
@@ -125,10 +154,21 @@ protected:
 	std::mutex _unpairThreadMutex;
 	std::thread _unpairThread;
 
+	class PeerLoadJob
+	{
+	public:
+		int32_t id = 0;
+		int32_t address = 0;
+		std::string serialNumber;
+		std::shared_ptr<BaseLib::Database::DataTable> variables;
+		std::shared_ptr<MAXPeer> peer;
+	};
+	void loadPeersThread(std::vector<PeerLoadJob>* jobs, std::atomic<uint32_t>* nextJob);
+
 	std::shared_ptr<MAXPeer> createPeer(int32_t address, int32_t firmwareVersion, uint32_t deviceType, std::string serialNumber, bool save = true);
 	void deletePeer(uint64_t id);
+	void publishPeerIndex();
 	std::mutex _peerInitMutex;
-	std::mutex _enqueuePendingQueuesMutex;
 	virtual void setUpMAXMessages();
 	virtual void worker();
 	virtual void init();
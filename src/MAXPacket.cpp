@@ -30,6 +30,7 @@
 #include "MAXPacket.h"
 #include "GD.h"
 
+#include <charconv>
 #include <iomanip>
 
 namespace MAX
@@ -48,7 +49,7 @@ MAXPacket::MAXPacket(std::vector<uint8_t>& packet, bool rssiByte, int64_t timeRe
 	import(packet, rssiByte);
 }
 
-MAXPacket::MAXPacket(std::string packet, int64_t timeReceived)
+MAXPacket::MAXPacket(std::string_view packet, int64_t timeReceived)
 {
 	_timeReceived = timeReceived;
     import(packet);
@@ -122,14 +123,14 @@ void MAXPacket::import(std::vector<uint8_t>& packet, bool rssiByte)
     }
 }
 
-void MAXPacket::import(std::string& packet, bool removeFirstCharacter)
+void MAXPacket::import(std::string_view packet, bool removeFirstCharacter)
 {
 	try
 	{
 		uint32_t startIndex = removeFirstCharacter ? 1 : 0;
 		if(packet.size() < startIndex + 20)
 		{
-			GD::out.printError("Error: Packet is too short: " + packet);
+			GD::out.printError("Error: Packet is too short: " + std::string(packet));
 			return;
 		}
 		if(packet.size() > 400)
@@ -149,7 +150,7 @@ void MAXPacket::import(std::string& packet, bool removeFirstCharacter)
 		uint32_t endIndex = startIndex + 2 + (_length * 2) - 1;
 		if(endIndex >= packet.size())
 		{
-			GD::out.printWarning("Warning: Packet is shorter than value of packet length byte: " + packet);
+			GD::out.printWarning("Warning: Packet is shorter than value of packet length byte: " + std::string(packet));
 			endIndex = packet.size() - 1;
 		}
 		_payload.clear();
@@ -228,12 +229,13 @@ std::vector<uint8_t> MAXPacket::byteArray()
     return std::vector<uint8_t>();
 }
 
-uint8_t MAXPacket::getByte(std::string hexString)
+uint8_t MAXPacket::getByte(std::string_view hexString)
 {
 	try
 	{
-		uint8_t value = 0;
-		try	{ value = std::stoi(hexString, 0, 16); } catch(...) {}
+		//Parses in place. Invalid input results in 0 like before.
+		uint32_t value = 0;
+		std::from_chars(hexString.data(), hexString.data() + hexString.size(), value, 16);
 		return value;
 	}
 	catch(const std::exception& ex)
@@ -243,12 +245,12 @@ uint8_t MAXPacket::getByte(std::string hexString)
 	return 0;
 }
 
-int32_t MAXPacket::getInt(std::string hexString)
+int32_t MAXPacket::getInt(std::string_view hexString)
 {
 	try
 	{
-		int32_t value = 0;
-		try	{ value = std::stoll(hexString, 0, 16); } catch(...) {}
+		int64_t value = 0;
+		std::from_chars(hexString.data(), hexString.data() + hexString.size(), value, 16);
 		return value;
 	}
 	catch(const std::exception& ex)
@@ -330,19 +332,27 @@ void MAXPacket::setPosition(double index, double size, std::vector<uint8_t>& val
 std::vector<uint8_t> MAXPacket::getPosition(double index, double size, int32_t mask)
 {
 	std::vector<uint8_t> result;
+	getPosition(index, size, mask, result);
+	return result;
+}
+
+void MAXPacket::getPosition(double index, double size, int32_t mask, std::vector<uint8_t>& result)
+{
+	//Fills result instead of returning a new vector, so callers can reuse the buffer
+	result.clear();
 	try
 	{
 		if(size < 0)
 		{
 			GD::out.printError("Error: Negative size not allowed.");
 			result.push_back(0);
-			return result;
+			return;
 		}
 		if(index < 0)
 		{
 			GD::out.printError("Error: Packet index < 0 requested.");
 			result.push_back(0);
-			return result;
+			return;
 		}
 		if(index < 9)
 		{
@@ -350,7 +360,7 @@ std::vector<uint8_t> MAXPacket::getPosition(double index, double size, int32_t m
 			{
 				GD::out.printError("Error: Packet index < 9 and size > 1 requested.");
 				result.push_back(0);
-				return result;
+				return;
 			}
 
 			uint32_t bitSize = std::lround(size * 10);
@@ -364,7 +374,7 @@ std::vector<uint8_t> MAXPacket::getPosition(double index, double size, int32_t m
 			else if(intIndex == 6) result.push_back(((_destinationAddress >> 16) >> (std::lround(index * 10) % 10)) & _bitmask[bitSize]);
 			else if(intIndex == 7) result.push_back(((_destinationAddress >> 8) >> (std::lround(index * 10) % 10)) & _bitmask[bitSize]);
 			else if(intIndex == 8) result.push_back((_destinationAddress >> (std::lround(index * 10) % 10)) & _bitmask[bitSize]);
-			return result;
+			return;
 		}
 		index -= 9;
 		double byteIndex = std::floor(index);
@@ -372,7 +382,7 @@ std::vector<uint8_t> MAXPacket::getPosition(double index, double size, int32_t m
 		if(byteIndex >= _payload.size())
 		{
 			result.push_back(0);
-			return result;
+			return;
 		}
 		if(byteIndex != index || size < 0.8) //0.8 == 8 Bits
 		{
@@ -380,7 +390,7 @@ std::vector<uint8_t> MAXPacket::getPosition(double index, double size, int32_t m
 			{
 				GD::out.printError("Error: Partial byte index > 1 requested.");
 				result.push_back(0);
-				return result;
+				return;
 			}
 			//The round is necessary, because for example (uint32_t)(0.2 * 10) is 1
 			uint32_t bitSize = std::lround(size * 10);
@@ -408,14 +418,13 @@ std::vector<uint8_t> MAXPacket::getPosition(double index, double size, int32_t m
 			}
 		}
 		if(result.empty()) result.push_back(0);
-		return result;
+		return;
 	}
 	catch(const std::exception& ex)
     {
     	GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
     result.push_back(0);
-    return result;
 }
 
 bool MAXPacket::equals(std::shared_ptr<MAXPacket>& rhs)
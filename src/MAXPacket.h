@@ -31,8 +31,10 @@
 #define MAXPACKET_H_
 
 #include <homegear-base/BaseLib.h>
+#include "FrameFields.h"
 
 #include <map>
+#include <string_view>
 
 namespace MAX
 {
@@ -42,11 +44,11 @@ public:
     //Properties
     MAXPacket();
     MAXPacket(std::vector<uint8_t>&, bool rssiByte, int64_t timeReceived = 0);
-    MAXPacket(std::string packet, int64_t timeReceived = 0);
+    MAXPacket(std::string_view packet, int64_t timeReceived = 0);
     MAXPacket(uint8_t messageCounter, uint8_t messageType, uint8_t messageSubtype, int32_t senderAddress, int32_t destinationAddress, std::vector<uint8_t> payload, bool burst);
     virtual ~MAXPacket();
 
-    void import(std::string& packet, bool removeFirstCharacter = true);
+    void import(std::string_view packet, bool removeFirstCharacter = true);
     void import(std::vector<uint8_t>& packet, bool rssiByte);
 
     uint8_t length() { return _length; }
@@ -64,7 +66,10 @@ public:
     std::string hexString();
     std::vector<uint8_t> byteArray();
     std::vector<uint8_t> getPosition(double index, double size, int32_t mask);
+    void getPosition(double index, double size, int32_t mask, std::vector<uint8_t>& result);
     void setPosition(double index, double size, std::vector<uint8_t>& value);
+    void getPosition(FrameFields::Extract extract, std::vector<uint8_t>& result) { extract(_payload, result); }
+    void setPosition(FrameFields::Insert insert, std::vector<uint8_t>& value) { insert(_payload, value); _length = 9 + _payload.size(); }
 
     bool equals(std::shared_ptr<MAXPacket>& rhs);
 protected:
@@ -80,8 +85,8 @@ protected:
     uint8_t _rssiDevice = 0;
     std::vector<uint8_t> _payload;
 
-    virtual uint8_t getByte(std::string);
-    int32_t getInt(std::string);
+    virtual uint8_t getByte(std::string_view hexString);
+    int32_t getInt(std::string_view hexString);
 };
 
 }
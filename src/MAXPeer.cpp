@@ -35,6 +35,8 @@
 
 namespace MAX
 {
+std::mutex MAXPeer::_loadMutex;
+
 std::shared_ptr<BaseLib::Systems::ICentral> MAXPeer::getCentral()
 {
 	try
@@ -79,6 +81,8 @@ MAXPeer::MAXPeer(uint32_t parentID, IPeerEventSink* eventHandler) : Peer(GD::bl,
 	setPhysicalInterface(GD::defaultPhysicalInterface);
 	_lastTimePacket = BaseLib::HelperFunctions::getTime() + (BaseLib::HelperFunctions::getRandomNumber(1, 1000) * 10000);
 	_randomSleep = BaseLib::HelperFunctions::getRandomNumber(0, 1800000);
+	_eventEnvelope.setCoalescingWindow(std::max(0, BaseLib::Math::getNumber(GD::settings->getString("eventcoalescingwindow"))));
+	_messageCounter.init(BaseLib::Math::getNumber(GD::settings->getString("messagecounterlease")), [this](uint8_t leaseEnd) { saveVariable(5, (int32_t)leaseEnd); });
 }
 
 MAXPeer::MAXPeer(int32_t id, int32_t address, std::string serialNumber, uint32_t parentID, IPeerEventSink* eventHandler) : Peer(GD::bl, id, address, serialNumber, parentID, eventHandler)
@@ -86,6 +90,8 @@ MAXPeer::MAXPeer(int32_t id, int32_t address, std::string serialNumber, uint32_t
 	setPhysicalInterface(GD::defaultPhysicalInterface);
 	_lastTimePacket = BaseLib::HelperFunctions::getTime() + (BaseLib::HelperFunctions::getRandomNumber(1, 1000) * 10000);
 	_randomSleep = BaseLib::HelperFunctions::getRandomNumber(0, 1800000);
+	_eventEnvelope.setCoalescingWindow(std::max(0, BaseLib::Math::getNumber(GD::settings->getString("eventcoalescingwindow"))));
+	_messageCounter.init(BaseLib::Math::getNumber(GD::settings->getString("messagecounterlease")), [this](uint8_t leaseEnd) { saveVariable(5, (int32_t)leaseEnd); });
 }
 
 MAXPeer::~MAXPeer()
@@ -104,6 +110,7 @@ void MAXPeer::worker()
 		if(_rpcDevice)
 		{
 			serviceMessages->checkUnreach(_rpcDevice->timeout, getLastPacketReceived());
+			indexServiceMessage(ServiceMessageIndex::unreach, serviceMessages->getUnreach());
 			if(_rpcDevice->needsTime && (time - _lastTimePacket) > 43200000)
 			{
 				sendTime();
@@ -111,7 +118,7 @@ void MAXPeer::worker()
 		}
 		if(serviceMessages->getConfigPending())
 		{
-			if(!pendingQueues || pendingQueues->empty()) serviceMessages->setConfigPending(false);
+			if(!pendingQueues || pendingQueues->empty()) setConfigPending(false);
 			else if((_bl->hf.getTime() - serviceMessages->getConfigPendingSetTime()) > (900000 + _randomSleep))
 			{
 				if((getRXModes() & HomegearDevice::ReceiveModes::always) || (getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio))
@@ -122,11 +129,46 @@ void MAXPeer::worker()
 				}
 			}
 		}
+		if(_eventEnvelope.coalescing()) raiseCoalescedEvents(false);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+int64_t MAXPeer::getNextWorkerRun()
+{
+	//Returns the time in milliseconds when worker() has something to do next or 0 if there is nothing to do.
+	try
+	{
+		if(_disposing || !serviceMessages) return 0;
+		int64_t nextRun = 0;
+		if(_rpcDevice)
+		{
+			if(_rpcDevice->timeout > 0 && !serviceMessages->getUnreach()) nextRun = ((int64_t)getLastPacketReceived() + _rpcDevice->timeout + 1) * 1000;
+			if(_rpcDevice->needsTime)
+			{
+				int64_t timeSync = _lastTimePacket + 43200001;
+				if(nextRun == 0 || timeSync < nextRun) nextRun = timeSync;
+			}
+		}
+		if(serviceMessages->getConfigPending())
+		{
+			int64_t configRetry = 0;
+			if(!pendingQueues || pendingQueues->empty()) configRetry = BaseLib::HelperFunctions::getTime();
+			else if((getRXModes() & HomegearDevice::ReceiveModes::always) || (getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio)) configRetry = serviceMessages->getConfigPendingSetTime() + 900001 + _randomSleep;
+			if(configRetry != 0 && (nextRun == 0 || configRetry < nextRun)) nextRun = configRetry;
+		}
+		int64_t eventDue = _eventEnvelope.nextDue();
+		if(eventDue != 0 && (nextRun == 0 || eventDue < nextRun)) nextRun = eventDue;
+		return nextRun;
 	}
 	catch(const std::exception& ex)
 	{
 		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
 	}
+	return 0;
 }
 
 std::string MAXPeer::handleCliCommand(std::string command)
@@ -424,7 +466,7 @@ void MAXPeer::loadVariables(BaseLib::Systems::ICentral* central, std::shared_ptr
 			switch(row->second.at(2)->intValue)
 			{
 			case 5:
-				_messageCounter = row->second.at(3)->intValue;
+				_messageCounter.load(row->second.at(3)->intValue);
 				break;
 			case 12:
 				unserializePeers(row->second.at(5)->binaryValue);
@@ -448,10 +490,17 @@ void MAXPeer::loadVariables(BaseLib::Systems::ICentral* central, std::shared_ptr
 }
 
 bool MAXPeer::load(BaseLib::Systems::ICentral* central)
+{
+	return load(central, std::shared_ptr<BaseLib::Database::DataTable>());
+}
+
+bool MAXPeer::load(BaseLib::Systems::ICentral* central, std::shared_ptr<BaseLib::Database::DataTable> variableRows)
 {
 	try
 	{
-		std::shared_ptr<BaseLib::Database::DataTable> rows;
+		//Rows might have been fetched in advance
+		std::shared_ptr<BaseLib::Database::DataTable> rows = variableRows;
+		std::unique_lock<std::mutex> loadGuard(_loadMutex);
 		loadVariables(central, rows);
 
 		_rpcDevice = GD::family->getRpcDevices()->find(_deviceType, _firmwareVersion, -1);
@@ -463,10 +512,14 @@ bool MAXPeer::load(BaseLib::Systems::ICentral* central)
 		initializeTypeString();
 		std::string entry;
 		loadConfig();
-		initializeCentralConfig();
-
+		Peer::initializeCentralConfig();
 		serviceMessages.reset(new BaseLib::Systems::ServiceMessages(_bl, _peerID, _serialNumber, this));
 		serviceMessages->load();
+		loadGuard.unlock();
+
+		//Only touches this peer's own data, so this runs in parallel (see initializeCentralConfig())
+		indexValues();
+		indexServiceMessages();
 
 		return true;
 	}
@@ -483,7 +536,7 @@ void MAXPeer::saveVariables()
 	{
 		if(_peerID == 0) return;
 		Peer::saveVariables();
-		saveVariable(5, (int32_t)_messageCounter);
+		saveVariable(5, (int32_t)_messageCounter.leaseEnd());
 		savePeers(); //12
 		savePendingQueues(); //16
 		saveVariable(19, _physicalInterfaceID);
@@ -594,6 +647,7 @@ std::string MAXPeer::printConfig()
 {
 	try
 	{
+		std::shared_lock<std::shared_mutex> configGuard(_configMutex);
 		std::ostringstream stringStream;
 		stringStream << "MASTER" << std::endl;
 		stringStream << "{" << std::endl;
@@ -678,133 +732,31 @@ std::string MAXPeer::printConfig()
     return "";
 }
 
-void MAXPeer::getValuesFromPacket(std::shared_ptr<MAXPacket> packet, std::vector<FrameValues>& frameValues)
+void MAXPeer::getValuesFromPacket(std::shared_ptr<MAXPacket> packet, DecodeResult& result)
 {
 	try
 	{
-		if(!_rpcDevice) return;
-		//equal_range returns all elements with "0" or an unknown element as argument
-		if(_rpcDevice->packetsByMessageType.find(packet->messageType()) == _rpcDevice->packetsByMessageType.end()) return;
-		std::pair<PacketsByMessageType::iterator, PacketsByMessageType::iterator> range = _rpcDevice->packetsByMessageType.equal_range((uint32_t)packet->messageType());
-		if(range.first == _rpcDevice->packetsByMessageType.end()) return;
-		PacketsByMessageType::iterator i = range.first;
-		do
+		result.clear();
+		if(!_rpcDevice || !_parameterIndex) return;
+		DecodePlan* decodePlan = _parameterIndex->getDecodePlan();
+		if(!decodePlan) return;
+		decodePlan->decode(_address, packet, result);
+
+		//Check for low battery
+		if(result.lowBat != -1)
 		{
-			FrameValues currentFrameValues;
-			PPacket frame(i->second);
-			if(!frame) continue;
-			if(frame->direction == BaseLib::DeviceDescription::Packet::Direction::Enum::toCentral && packet->senderAddress() != _address) continue;
-			if(frame->direction == BaseLib::DeviceDescription::Packet::Direction::Enum::fromCentral && packet->destinationAddress() != _address) continue;
-			if(packet->payload().empty()) break;
-			if(frame->subtype > -1 && packet->messageSubtype() != frame->subtype) continue;
-			int32_t channelIndex = frame->channelIndex;
-			int32_t channel = -1;
-			if(channelIndex >= 9 && (signed)packet->payload().size() > (channelIndex - 9)) channel = packet->payload().at(channelIndex - 9) - frame->channelIndexOffset;
-			if(channel > -1 && frame->channelSize < 1.0) channel &= (0xFF >> (8 - std::lround(frame->channelSize * 10) % 10));
-			if(frame->channel > -1) channel = frame->channel;
-			if(frame->length > 0 && packet->length() != frame->length) continue;
-			currentFrameValues.frameID = frame->id;
-
-			for(BinaryPayloads::iterator j = frame->binaryPayloads.begin(); j != frame->binaryPayloads.end(); ++j)
+			if(result.lowBat == 1)
 			{
-				std::vector<uint8_t> data;
-				if((*j)->size > 0 && (*j)->index > 0)
-				{
-					if(((int32_t)(*j)->index) - 9 >= (signed)packet->payload().size()) continue;
-					data = packet->getPosition((*j)->index, (*j)->size, -1);
-
-					if((*j)->constValueInteger > -1)
-					{
-						int32_t intValue = 0;
-						_bl->hf.memcpyBigEndian(intValue, data);
-						if(intValue != (*j)->constValueInteger) break; else continue;
-					}
-
-					//Process split data
-					if((*j)->size2 > 0 && (*j)->index2 > 0 && (*j)->index2Offset > 0) //Only
-					{
-						if((*j)->size2 > 1.0) GD::out.printWarning("Warning: size2 of frame parameter is larger than 1 byte. That is not supported.");
-						else if(((int32_t)(*j)->index2) - 9 < (signed)packet->payload().size())
-						{
-							std::vector<uint8_t> data2 = packet->getPosition((*j)->index2, (*j)->size2, -1);
-							int32_t byteIndex = (*j)->index2Offset / 8;
-							int32_t bitIndex = (*j)->index2Offset % 8;
-							if(data2.size() == 1)
-							{
-								if(byteIndex < (signed)data.size())
-								{
-									data.at(byteIndex) |= (data2.at(0) << bitIndex);
-								}
-								else
-								{
-									data2.insert(data2.end(), data.begin(), data.end());
-									data = data2;
-								}
-							}
-						}
-					}
-				}
-				else if((*j)->constValueInteger > -1)
-				{
-					_bl->hf.memcpyBigEndian(data, (*j)->constValueInteger);
-				}
-				else continue;
-
-				//Check for low battery
-				if((*j)->parameterId == "LOWBAT")
-				{
-					if(data.size() > 0 && data.at(0))
-					{
-						serviceMessages->set("LOWBAT", true);
-						if(_bl->debugLevel >= 4) GD::out.printInfo("Info: LOWBAT of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + " was set to \"true\".");
-					}
-					else serviceMessages->set("LOWBAT", false);
-				}
-
-				for(std::vector<PParameter>::iterator k = frame->associatedVariables.begin(); k != frame->associatedVariables.end(); ++k)
-				{
-					if((*k)->physical->groupId != (*j)->parameterId) continue;
-					currentFrameValues.parameterSetType = (*k)->parent()->type();
-					bool setValues = false;
-					if(currentFrameValues.paramsetChannels.empty()) //Fill paramsetChannels
-					{
-						int32_t startChannel = (channel < 0) ? 0 : channel;
-						int32_t endChannel;
-						//When fixedChannel is -2 (means '*') cycle through all channels
-						if(frame->channel == -2)
-						{
-							startChannel = 0;
-							endChannel = _rpcDevice->functions.rbegin()->first;
-						}
-						else endChannel = startChannel;
-						for(int32_t l = startChannel; l <= endChannel; l++)
-						{
-							Functions::iterator functionIterator = _rpcDevice->functions.find(l);
-							if(functionIterator == _rpcDevice->functions.end()) continue;
-							PParameterGroup parameterGroup = functionIterator->second->getParameterGroup(currentFrameValues.parameterSetType);
-							if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
-							currentFrameValues.paramsetChannels.push_back(l);
-							currentFrameValues.values[(*k)->id].channels.push_back(l);
-							setValues = true;
-						}
-					}
-					else //Use paramsetChannels
-					{
-						for(std::list<uint32_t>::const_iterator l = currentFrameValues.paramsetChannels.begin(); l != currentFrameValues.paramsetChannels.end(); ++l)
-						{
-							Functions::iterator functionIterator = _rpcDevice->functions.find(*l);
-							if(functionIterator == _rpcDevice->functions.end()) continue;
-							PParameterGroup parameterGroup = functionIterator->second->getParameterGroup(currentFrameValues.parameterSetType);
-							if(!parameterGroup || parameterGroup->parameters.find((*k)->id) == parameterGroup->parameters.end()) continue;
-							currentFrameValues.values[(*k)->id].channels.push_back(*l);
-							setValues = true;
-						}
-					}
-					if(setValues) currentFrameValues.values[(*k)->id].value = data;
-				}
+				serviceMessages->set("LOWBAT", true);
+				indexServiceMessage(ServiceMessageIndex::lowbat, true);
+				if(_bl->debugLevel >= 4) GD::out.printInfo("Info: LOWBAT of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + " was set to \"true\".");
+			}
+			else
+			{
+				serviceMessages->set("LOWBAT", false);
+				indexServiceMessage(ServiceMessageIndex::lowbat, false);
 			}
-			if(!currentFrameValues.values.empty()) frameValues.push_back(currentFrameValues);
-		} while(++i != range.second && i != _rpcDevice->packetsByMessageType.end());
+		}
 	}
 	catch(const std::exception& ex)
     {
@@ -833,6 +785,200 @@ PParameterGroup MAXPeer::getParameterSet(int32_t channel, ParameterGroup::Type::
 	return PParameterGroup();
 }
 
+void MAXPeer::saveValue(ParameterGroup::Type::Enum type, uint32_t channel, const std::string& parameterId, std::vector<uint8_t>& value)
+{
+	try
+	{
+		std::shared_ptr<MAXCentral> central = std::dynamic_pointer_cast<MAXCentral>(getCentral());
+		if(central && central->getParameterWriteBuffer().enqueue(_peerID, type, channel, parameterId, value)) return;
+		persistParameter(type, channel, parameterId, value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::persistParameter(ParameterGroup::Type::Enum type, uint32_t channel, const std::string& parameterId, std::vector<uint8_t>& value)
+{
+	try
+	{
+		//The first write of a parameter inserts its row and sets databaseId. Writes are serialized, so a write started
+		//while the insert is in progress sees the new ID and doesn't insert a second row.
+		std::lock_guard<std::mutex> databaseIdGuard(_databaseIdMutex);
+		if(type != ParameterGroup::Type::Enum::variables)
+		{
+			saveParameter(0, type, channel, parameterId, value);
+			return;
+		}
+		//The index avoids searching valuesCentral, which the receiving threads might modify
+		RpcConfigurationParameter* parameter = _parameterIndex ? getValueByIndex(channel, _parameterIndex->getIndex(parameterId)) : nullptr;
+		if(!parameter)
+		{
+			auto channelIterator = valuesCentral.find(channel);
+			if(channelIterator == valuesCentral.end()) return;
+			auto parameterIterator = channelIterator->second.find(parameterId);
+			//Don't let BaseLib create the value from this thread
+			if(parameterIterator == channelIterator->second.end()) return;
+			parameter = &parameterIterator->second;
+		}
+		if(parameter->databaseId > 0) saveParameter(parameter->databaseId, value);
+		else saveParameter(0, type, channel, parameterId, value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::initializeCentralConfig()
+{
+	try
+	{
+		Peer::initializeCentralConfig();
+		indexValues();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::indexValues()
+{
+	try
+	{
+		_parameterIndex = ParameterIndex::get(_rpcDevice);
+		if(!_parameterIndex) return;
+		_rssiDeviceIndex = _parameterIndex->getIndex("RSSI_DEVICE");
+		//All channels of the device get slots, so values created later in valuesCentral can be indexed
+		uint32_t channelCount = _rpcDevice->functions.empty() ? 0 : _rpcDevice->functions.rbegin()->first + 1;
+		for(auto& channel : valuesCentral)
+		{
+			if(channel.first >= channelCount) channelCount = channel.first + 1;
+		}
+		std::vector<std::vector<std::atomic<RpcConfigurationParameter*>>> valuesByIndex;
+		valuesByIndex.reserve(channelCount);
+		for(uint32_t i = 0; i < channelCount; i++) valuesByIndex.emplace_back(_parameterIndex->size());
+		for(auto& channel : valuesCentral)
+		{
+			for(auto& parameter : channel.second)
+			{
+				uint32_t index = _parameterIndex->getIndex(parameter.first);
+				if(index != ParameterIndex::noParameter) valuesByIndex[channel.first][index].store(&parameter.second);
+			}
+		}
+		_valuesByIndex.swap(valuesByIndex);
+		{
+			std::lock_guard<std::mutex> convertedValuesGuard(_convertedValuesMutex);
+			_convertedValues.clear();
+		}
+		_eventEnvelope.init(_peerID, _serialNumber, _parameterIndex, _valuesByIndex.size());
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::setConfigPending(bool value)
+{
+	try
+	{
+		serviceMessages->setConfigPending(value);
+		indexServiceMessage(ServiceMessageIndex::configPending, value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::setUnreach(bool value, bool requeue)
+{
+	try
+	{
+		serviceMessages->setUnreach(value, requeue);
+		indexServiceMessage(ServiceMessageIndex::unreach, serviceMessages->getUnreach());
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::endUnreach()
+{
+	try
+	{
+		serviceMessages->endUnreach();
+		indexServiceMessage(ServiceMessageIndex::unreach, false);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::indexServiceMessage(ServiceMessageIndex::Flag flag, bool value)
+{
+	try
+	{
+		if(flag >= ServiceMessageIndex::flagCount || _peerID == 0) return;
+		uint32_t bit = 1u << flag;
+		//The peer's flags and the central's index are updated under one lock, so they can't diverge and a peer removed
+		//from the index isn't added again.
+		std::lock_guard<std::mutex> serviceMessageIndexGuard(_serviceMessageIndexMutex);
+		if(_serviceMessageIndexRemoved) return;
+		uint32_t flags = value ? _serviceMessageFlags.fetch_or(bit) : _serviceMessageFlags.fetch_and(~bit);
+		if(((flags & bit) != 0) == value) return; //Unchanged
+		std::shared_ptr<MAXCentral> central = std::dynamic_pointer_cast<MAXCentral>(getCentral());
+		if(central) central->getServiceMessageIndex().set(_peerID, flag, value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::removeFromServiceMessageIndex()
+{
+	try
+	{
+		std::lock_guard<std::mutex> serviceMessageIndexGuard(_serviceMessageIndexMutex);
+		_serviceMessageIndexRemoved = true;
+		std::shared_ptr<MAXCentral> central = std::dynamic_pointer_cast<MAXCentral>(getCentral());
+		if(central) central->getServiceMessageIndex().remove(_peerID);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::indexServiceMessages()
+{
+	try
+	{
+		if(!serviceMessages) return;
+		indexServiceMessage(ServiceMessageIndex::unreach, serviceMessages->getUnreach());
+		indexServiceMessage(ServiceMessageIndex::configPending, serviceMessages->getConfigPending());
+		//LOWBAT and CENTRAL_ADDRESS_SPOOFED are taken from the stored values of the maintenance channel.
+		if(!_parameterIndex) return;
+		for(ServiceMessageIndex::Flag flag : { ServiceMessageIndex::lowbat, ServiceMessageIndex::centralAddressSpoofed })
+		{
+			RpcConfigurationParameter* parameter = getValueByIndex(0, _parameterIndex->getIndex(ServiceMessageIndex::getName(flag)));
+			if(!parameter) continue;
+			std::vector<uint8_t> data = parameter->getBinaryData();
+			indexServiceMessage(flag, !data.empty() && data.at(0) != 0);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
 void MAXPeer::packetReceived(std::shared_ptr<MAXPacket> packet)
 {
 	try
@@ -846,7 +992,8 @@ void MAXPeer::packetReceived(std::shared_ptr<MAXPacket> packet)
 		if(packet->messageType() == 0) packet->setMessageType(0xFF);
 		setLastPacketReceived();
 		setRSSIDevice(packet->rssiDevice());
-		serviceMessages->endUnreach();
+		endUnreach();
+		central->scheduleWorker(_peerID, getNextWorkerRun());
 
         if(packet->destinationAddress() != 0 && _lastReceivedMessageCounter == packet->messageCounter())
         {
@@ -855,52 +1002,80 @@ void MAXPeer::packetReceived(std::shared_ptr<MAXPacket> packet)
         }
         _lastReceivedMessageCounter = packet->messageCounter();
 
-		std::vector<FrameValues> frameValues;
-		getValuesFromPacket(packet, frameValues);
-		std::map<uint32_t, std::shared_ptr<std::vector<std::string>>> valueKeys;
-		std::map<uint32_t, std::shared_ptr<std::vector<PVariable>>> rpcValues;
-		//Loop through all matching frames
-		for(std::vector<FrameValues>::iterator a = frameValues.begin(); a != frameValues.end(); ++a)
+		//Reused for every packet handled by this thread
+		thread_local DecodeResult decodeResult;
+		getValuesFromPacket(packet, decodeResult);
+		//Values to raise events for, by channel. Reused for every packet handled by this thread.
+		struct ChannelValues
+		{
+			uint32_t channel = 0;
+			std::vector<uint32_t> parameterIndexes;
+			std::shared_ptr<std::vector<PVariable>> values;
+		};
+		thread_local std::vector<ChannelValues> channelValues;
+		uint32_t channelCount = 0;
+		//Loop through the values of all matching frames
+		for(uint32_t i = 0; i < decodeResult.size(); i++)
 		{
-			PPacket frame;
-			if(!a->frameID.empty()) frame = _rpcDevice->packetsById.at(a->frameID);
+			DecodedValue& decodedValue = decodeResult.at(i);
+			uint32_t channel = decodedValue.channel;
+			const std::string& parameterId = _parameterIndex->getName(decodedValue.parameterIndex);
+			if(!pendingQueues->empty() && pendingQueues->exists(parameterId, channel)) continue; //Don't set queued values
+
+			BaseLib::Systems::RpcConfigurationParameter* valueByIndex = getValueByIndex(channel, decodedValue.parameterIndex);
+			if(!valueByIndex)
+			{
+				//Values the device description doesn't define for this channel
+				valueByIndex = &valuesCentral[channel][parameterId];
+				indexValue(channel, decodedValue.parameterIndex, valueByIndex);
+			}
+			BaseLib::Systems::RpcConfigurationParameter& parameter = *valueByIndex;
+			parameter.setBinaryData(decodedValue.value);
+			invalidateConvertedValue(parameter);
+			saveValue(ParameterGroup::Type::Enum::variables, channel, parameterId, decodedValue.value);
+			if(_bl->debugLevel >= 4) GD::out.printInfo("Info: " + parameterId + " on channel " + std::to_string(channel) + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber  + " was set to 0x" + BaseLib::HelperFunctions::getHexString(decodedValue.value) + ".");
 
-			for(std::map<std::string, FrameValue>::iterator i = a->values.begin(); i != a->values.end(); ++i)
+			if(parameter.rpcParameter)
 			{
-				for(std::list<uint32_t>::const_iterator j = a->paramsetChannels.begin(); j != a->paramsetChannels.end(); ++j)
+				//Process service messages
+				if(parameter.rpcParameter->service && !decodedValue.value.empty())
 				{
-					if(std::find(i->second.channels.begin(), i->second.channels.end(), *j) == i->second.channels.end()) continue;
-					if(pendingQueues->exists(i->first, *j)) continue; //Don't set queued values
-					if(!valueKeys[*j] || !rpcValues[*j])
+					bool serviceValue = decodedValue.value.at(0) != 0;
+					if(parameter.rpcParameter->logical->type == ILogical::Type::Enum::tEnum)
 					{
-						valueKeys[*j].reset(new std::vector<std::string>());
-						rpcValues[*j].reset(new std::vector<PVariable>());
+						serviceMessages->set(parameterId, decodedValue.value.at(0), channel);
 					}
+					else if(parameter.rpcParameter->logical->type == ILogical::Type::Enum::tBoolean)
+					{
+						serviceMessages->set(parameterId, serviceValue);
+					}
+					//BaseLib always gets the value, the index only mirrors it for the central's service message queries
+					indexServiceMessage(_parameterIndex->getServiceFlag(decodedValue.parameterIndex), serviceValue);
+				}
 
-					BaseLib::Systems::RpcConfigurationParameter& parameter = valuesCentral[*j][i->first];
-					parameter.setBinaryData(i->second.value);
-					if(parameter.databaseId > 0) saveParameter(parameter.databaseId, i->second.value);
-					else saveParameter(0, ParameterGroup::Type::Enum::variables, *j, i->first, i->second.value);
-					if(_bl->debugLevel >= 4) GD::out.printInfo("Info: " + i->first + " on channel " + std::to_string(*j) + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber  + " was set to 0x" + BaseLib::HelperFunctions::getHexString(i->second.value) + ".");
-
-					if(parameter.rpcParameter)
+				PVariable value = parameter.rpcParameter->convertFromPacket(decodedValue.value, parameter.mainRole(), true);
+				if(_eventEnvelope.coalescing()) _eventEnvelope.add(channel, decodedValue.parameterIndex, value);
+				else
+				{
+					ChannelValues* values = nullptr;
+					for(uint32_t j = 0; j < channelCount; j++)
 					{
-						//Process service messages
-						if(parameter.rpcParameter->service && !i->second.value.empty())
+						if(channelValues[j].channel == channel)
 						{
-							if(parameter.rpcParameter->logical->type == ILogical::Type::Enum::tEnum)
-							{
-								serviceMessages->set(i->first, i->second.value.at(0), *j);
-							}
-							else if(parameter.rpcParameter->logical->type == ILogical::Type::Enum::tBoolean)
-							{
-								serviceMessages->set(i->first, (bool)i->second.value.at(0));
-							}
+							values = &channelValues[j];
+							break;
 						}
-
-						valueKeys[*j]->push_back(i->first);
-						rpcValues[*j]->push_back(parameter.rpcParameter->convertFromPacket(i->second.value, parameter.mainRole(), true));
 					}
+					if(!values)
+					{
+						if(channelCount == channelValues.size()) channelValues.emplace_back();
+						values = &channelValues[channelCount++];
+						values->channel = channel;
+						values->parameterIndexes.clear();
+						values->values = std::make_shared<std::vector<PVariable>>();
+					}
+					values->parameterIndexes.push_back(decodedValue.parameterIndex);
+					values->values->push_back(value);
 				}
 			}
 		}
@@ -927,18 +1102,15 @@ void MAXPeer::packetReceived(std::shared_ptr<MAXPacket> packet)
 		}
 		else if(packet->messageType() != 0x02 && packet->messageType() != 0xFF && packet->destinationAddress() == central->getAddress()) central->sendOK(packet->messageCounter(), packet->senderAddress());
 
-		//if(!rpcValues.empty() && !resendPacket)
-		if(!rpcValues.empty())
+		for(uint32_t i = 0; i < channelCount; i++)
 		{
-			for(std::map<uint32_t, std::shared_ptr<std::vector<std::string>>>::iterator j = valueKeys.begin(); j != valueKeys.end(); ++j)
-			{
-				if(j->second->empty()) continue;
-				std::string eventSource = "device-" + std::to_string(_peerID);
-				std::string address(_serialNumber + ":" + std::to_string(j->first));
-				raiseEvent(eventSource, _peerID, j->first, j->second, rpcValues.at(j->first));
-				raiseRPCEvent(eventSource, _peerID, j->first, address, j->second, rpcValues.at(j->first));
-			}
+			ChannelValues& values = channelValues[i];
+			std::shared_ptr<std::vector<std::string>> valueKeys = _eventEnvelope.valueKeys(values.channel, values.parameterIndexes);
+			raiseEvent(_eventEnvelope.source(), _peerID, values.channel, valueKeys, values.values);
+			raiseRPCEvent(_eventEnvelope.source(), _peerID, values.channel, _eventEnvelope.address(values.channel), valueKeys, values.values);
+			values.values.reset();
 		}
+		if(_eventEnvelope.coalescing()) central->scheduleWorker(_peerID, getNextWorkerRun());
 	}
 	catch(const std::exception& ex)
     {
@@ -959,27 +1131,100 @@ std::string MAXPeer::getFirmwareVersionString(int32_t firmwareVersion)
 	return "";
 }
 
+PVariable MAXPeer::getConvertedValue(RpcConfigurationParameter& parameter, const PParameter& rpcParameter)
+{
+	try
+	{
+		//The lock is held while converting, so a value changed in the meantime can't be cached after its invalidation.
+		std::lock_guard<std::mutex> convertedValuesGuard(_convertedValuesMutex);
+		auto convertedValueIterator = _convertedValues.find(&parameter);
+		//Callers may modify the returned value
+		if(convertedValueIterator != _convertedValues.end()) return std::make_shared<Variable>(*convertedValueIterator->second);
+		std::vector<uint8_t> parameterData = parameter.getBinaryData();
+		PVariable value = rpcParameter->convertFromPacket(parameterData, parameter.mainRole(), false);
+		if(!value || rpcParameter->service) return value;
+		_convertedValues.emplace(&parameter, value);
+		return std::make_shared<Variable>(*value);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return PVariable();
+}
+
+void MAXPeer::onSaveParameter(std::string name, uint32_t channel, std::vector<uint8_t>& data)
+{
+	try
+	{
+		{
+			//BaseLib might insert the parameter's row and set its databaseId (see persistParameter())
+			std::lock_guard<std::mutex> databaseIdGuard(_databaseIdMutex);
+			Peer::onSaveParameter(name, channel, data);
+		}
+		if(!_parameterIndex) return;
+		uint32_t index = _parameterIndex->getIndex(name);
+		RpcConfigurationParameter* parameter = getValueByIndex(channel, index);
+		if(parameter) invalidateConvertedValue(*parameter);
+		if(channel == 0 && !data.empty()) indexServiceMessage(_parameterIndex->getServiceFlag(index), data.at(0) != 0);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::invalidateConvertedValue(const RpcConfigurationParameter& parameter)
+{
+	try
+	{
+		std::lock_guard<std::mutex> convertedValuesGuard(_convertedValuesMutex);
+		_convertedValues.erase(&parameter);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MAXPeer::raiseCoalescedEvents(bool all)
+{
+	try
+	{
+		std::vector<EventEnvelope::Event> events;
+		_eventEnvelope.takeDue(all, events);
+		for(EventEnvelope::Event& event : events)
+		{
+			raiseEvent(_eventEnvelope.source(), _peerID, event.channel, event.valueKeys, event.values);
+			raiseRPCEvent(_eventEnvelope.source(), _peerID, event.channel, _eventEnvelope.address(event.channel), event.valueKeys, event.values);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
 void MAXPeer::setRSSIDevice(uint8_t rssi)
 {
 	try
 	{
 		if(_disposing || rssi == 0) return;
 		uint32_t time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-		if(valuesCentral.find(0) != valuesCentral.end() && valuesCentral.at(0).find("RSSI_DEVICE") != valuesCentral.at(0).end() && (time - _lastRSSIDevice) > 10)
+		BaseLib::Systems::RpcConfigurationParameter* parameter = getValueByIndex(0, _rssiDeviceIndex);
+		if(parameter && parameter->rpcParameter && (time - _lastRSSIDevice) > 10)
 		{
 			_lastRSSIDevice = time;
-			BaseLib::Systems::RpcConfigurationParameter& parameter = valuesCentral.at(0).at("RSSI_DEVICE");
 			std::vector<uint8_t> parameterData{ rssi };
-			parameter.setBinaryData(parameterData);
+			parameter->setBinaryData(parameterData);
+			invalidateConvertedValue(*parameter);
 
-			std::shared_ptr<std::vector<std::string>> valueKeys(new std::vector<std::string>({std::string("RSSI_DEVICE")}));
+			std::shared_ptr<std::vector<std::string>> valueKeys = _eventEnvelope.valueKeys(0, std::vector<uint32_t>{ _rssiDeviceIndex });
 			std::shared_ptr<std::vector<PVariable>> rpcValues(new std::vector<PVariable>());
-			rpcValues->push_back(parameter.rpcParameter->convertFromPacket(parameterData, parameter.mainRole(), false));
+			rpcValues->push_back(parameter->rpcParameter->convertFromPacket(parameterData, parameter->mainRole(), false));
 
-            std::string eventSource = "device-" + std::to_string(_peerID);
-            std::string address = _serialNumber + ":0";
-            raiseEvent(eventSource, _peerID, 0, valueKeys, rpcValues);
-            raiseRPCEvent(eventSource, _peerID, 0, address, valueKeys, rpcValues);
+            raiseEvent(_eventEnvelope.source(), _peerID, 0, valueKeys, rpcValues);
+            raiseRPCEvent(_eventEnvelope.source(), _peerID, 0, _eventEnvelope.address(0), valueKeys, rpcValues);
 		}
 	}
 	catch(const std::exception& ex)
@@ -997,7 +1242,7 @@ void MAXPeer::sendTime()
 	queue->peer = central->getPeer(_peerID);
 	queue->noSending = true;
 
-	queue->push(central->getTimePacket(central->messageCounter()->at(0)++, _address, getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+	queue->push(central->getTimePacket(central->broadcastCounter()->next(), _address, getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
 	queue->push(central->getMessages()->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
 	queue->parameterName = "CURRENT_TIME";
 	queue->channel = 0;
@@ -1007,6 +1252,20 @@ void MAXPeer::sendTime()
 }
 
 //RPC Methods
+PVariable MAXPeer::getAllConfig(BaseLib::PRpcClientInfo clientInfo)
+{
+	try
+	{
+		std::shared_lock<std::shared_mutex> configGuard(_configMutex);
+		return Peer::getAllConfig(clientInfo);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return Variable::createError(-32500, "Unknown application error.");
+}
+
 PVariable MAXPeer::getDeviceInfo(BaseLib::PRpcClientInfo clientInfo, std::map<std::string, bool> fields)
 {
 	try
@@ -1068,6 +1327,10 @@ PVariable MAXPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
 
 		if(type == ParameterGroup::Type::Enum::config)
 		{
+			//Parameters are modified, so the config is locked exclusively
+			std::unique_lock<std::shared_mutex> configGuard(_configMutex);
+			auto channelConfig = configCentral.find(channel);
+			if(channelConfig == configCentral.end()) return PVariable(new Variable(VariableType::tVoid));
 			std::map<int32_t, std::map<int32_t, std::vector<uint8_t>>> changedParameters;
 			//allParameters is necessary to temporarily store all values. It is used to set changedParameters.
 			//This is necessary when there are multiple variables per index and not all of them are changed.
@@ -1076,8 +1339,9 @@ PVariable MAXPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
 			{
 				if(i->first.empty() || !i->second) continue;
 				std::vector<uint8_t> value;
-				if(configCentral[channel].find(i->first) == configCentral[channel].end()) continue;
-				BaseLib::Systems::RpcConfigurationParameter& parameter = configCentral[channel][i->first];
+				auto parameterIterator = channelConfig->second.find(i->first);
+				if(parameterIterator == channelConfig->second.end()) continue;
+				BaseLib::Systems::RpcConfigurationParameter& parameter = parameterIterator->second;
 				if(!parameter.rpcParameter) continue;
 				parameter.rpcParameter->convertToPacket(i->second, parameter.mainRole(), value);
 				std::vector<uint8_t> shiftedValue = value;
@@ -1114,7 +1378,7 @@ PVariable MAXPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
 				std::vector<uint8_t> payload;
 				payload.push_back(0);
 				payload.push_back(i->first);
-				std::shared_ptr<MAXPacket> configPacket = std::shared_ptr<MAXPacket>(new MAXPacket(_messageCounter, 0x10, 0x00, central->getAddress(), _address, payload, getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
+				std::shared_ptr<MAXPacket> configPacket = std::shared_ptr<MAXPacket>(new MAXPacket(_messageCounter.next(), 0x10, 0x00, central->getAddress(), _address, payload, getRXModes() & HomegearDevice::ReceiveModes::wakeOnRadio));
 
 				for(std::map<int32_t, std::vector<uint8_t>>::iterator j = i->second.begin(); j != i->second.end(); ++j)
 				{
@@ -1128,8 +1392,9 @@ PVariable MAXPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
 				for(std::vector<std::shared_ptr<Parameter>>::iterator j = allListParameters.begin(); j!= allListParameters.end(); ++j)
 				{
 					if(i->second.find((int32_t)(*j)->physical->index) != i->second.end()) continue;
-					if(configCentral[channel].find((*j)->id) == configCentral[channel].end()) continue;
-					RpcConfigurationParameter& parameter = configCentral[channel][(*j)->id];
+					auto parameterIterator = channelConfig->second.find((*j)->id);
+					if(parameterIterator == channelConfig->second.end()) continue;
+					RpcConfigurationParameter& parameter = parameterIterator->second;
 					if(parameter.rpcParameter->physical->operationType != IPhysical::OperationType::Enum::config && parameter.rpcParameter->physical->operationType != IPhysical::OperationType::Enum::configString) continue;
 					std::vector<uint8_t> parameterData = parameter.getBinaryData();
 					configPacket->setPosition((*j)->physical->index - (std::lround(std::ceil(((*j)->physical->size))) - 1), (*j)->physical->size, parameterData);
@@ -1143,12 +1408,13 @@ PVariable MAXPeer::putParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
 					queue->push(configPacket);
 					queue->push(central->getMessages()->find(0x02, 0x02, std::vector<std::pair<uint32_t, int32_t>>()));
 					payload.clear();
-					setMessageCounter(_messageCounter + 1);
 					pendingQueues->push(queue);
 				}
 			}
 
-			serviceMessages->setConfigPending(true);
+			configGuard.unlock();
+			setConfigPending(true);
+			central->scheduleWorker(_peerID, getNextWorkerRun());
 			if(!onlyPushing) central->enqueuePendingQueues(_address);
 			raiseRPCUpdateDevice(_peerID, channel, _serialNumber + ":" + std::to_string(channel), 0);
 		}
@@ -1193,6 +1459,8 @@ PVariable MAXPeer::getParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
         auto central = getCentral();
         if(!central) return Variable::createError(-32500, "Could not get central.");
 
+		std::shared_lock<std::shared_mutex> configGuard(_configMutex, std::defer_lock);
+		if(type == ParameterGroup::Type::Enum::config) configGuard.lock();
 		for(Parameters::iterator i = parameterGroup->parameters.begin(); i != parameterGroup->parameters.end(); ++i)
 		{
 			if(i->second->id.empty()) continue;
@@ -1208,15 +1476,16 @@ PVariable MAXPeer::getParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
 				if(!i->second->readable) continue;
 				if(valuesCentral.find(channel) == valuesCentral.end()) continue;
 				if(valuesCentral[channel].find(i->second->id) == valuesCentral[channel].end()) continue;
-				auto& parameter = valuesCentral[channel][i->second->id];
-				std::vector<uint8_t> parameterData = parameter.getBinaryData();
-				element = i->second->convertFromPacket(parameterData, parameter.mainRole(), false);
+				element = getConvertedValue(valuesCentral[channel][i->second->id], i->second);
 			}
 			else if(type == ParameterGroup::Type::Enum::config)
 			{
-				if(configCentral.find(channel) == configCentral.end()) continue;
-				if(configCentral[channel].find(i->second->id) == configCentral[channel].end()) continue;
-                auto& parameter = configCentral[channel][i->second->id];
+				//Only a shared lock is held, so operator[] must not be used
+				auto channelConfig = configCentral.find(channel);
+				if(channelConfig == configCentral.end()) continue;
+				auto parameterIterator = channelConfig->second.find(i->second->id);
+				if(parameterIterator == channelConfig->second.end()) continue;
+				auto& parameter = parameterIterator->second;
 				std::vector<uint8_t> parameterData = parameter.getBinaryData();
 				element = i->second->convertFromPacket(parameterData, parameter.mainRole(), false);
 			}
@@ -1247,6 +1516,45 @@ PVariable MAXPeer::getParamset(BaseLib::PRpcClientInfo clientInfo, int32_t chann
     return Variable::createError(-32500, "Unknown application error.");
 }
 
+PVariable MAXPeer::getCachedValues(BaseLib::PRpcClientInfo clientInfo)
+{
+	try
+	{
+		if(_disposing) return Variable::createError(-32500, "Peer is disposing.");
+		PVariable channels(new Variable(VariableType::tStruct));
+		if(!_rpcDevice) return channels;
+		auto central = getCentral();
+		if(!central) return Variable::createError(-32500, "Could not get central.");
+		std::shared_ptr<BaseLib::Systems::Peer> peer = central->getPeer(_peerID);
+		for(Functions::iterator i = _rpcDevice->functions.begin(); i != _rpcDevice->functions.end(); ++i)
+		{
+			auto channelIterator = valuesCentral.find(i->first);
+			if(channelIterator == valuesCentral.end()) continue;
+			PParameterGroup parameterGroup = i->second->getParameterGroup(ParameterGroup::Type::Enum::variables);
+			if(!parameterGroup) continue;
+			PVariable variables(new Variable(VariableType::tStruct));
+			for(Parameters::iterator j = parameterGroup->parameters.begin(); j != parameterGroup->parameters.end(); ++j)
+			{
+				if(j->second->id.empty() || !j->second->readable) continue;
+				if(!j->second->visible && !j->second->service && !j->second->internal && !j->second->transform) continue;
+				if(!clientInfo->acls->checkVariableReadAccess(peer, i->first, j->first)) continue;
+				auto parameterIterator = channelIterator->second.find(j->second->id);
+				if(parameterIterator == channelIterator->second.end()) continue;
+				PVariable element = getConvertedValue(parameterIterator->second, j->second);
+				if(!element || element->type == VariableType::tVoid) continue;
+				variables->structValue->insert(StructElement(j->second->id, element));
+			}
+			if(!variables->structValue->empty()) channels->structValue->insert(StructElement(std::to_string(i->first), variables));
+		}
+		return channels;
+	}
+	catch(const std::exception& ex)
+    {
+        GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    return Variable::createError(-32500, "Unknown application error.");
+}
+
 PVariable MAXPeer::setInterface(BaseLib::PRpcClientInfo clientInfo, std::string interfaceID)
 {
 	try
@@ -1273,7 +1581,11 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 		Peer::setValue(clientInfo, channel, valueKey, value, wait); //Ignore result, otherwise setHomegerValue might not be executed
 		if(_disposing) return Variable::createError(-32500, "Peer is disposing.");
 		if(valueKey.empty()) return Variable::createError(-5, "Value key is empty.");
-		if(channel == 0 && serviceMessages->set(valueKey, value->booleanValue)) return PVariable(new Variable(VariableType::tVoid));
+		if(channel == 0 && serviceMessages->set(valueKey, value->booleanValue))
+		{
+			indexServiceMessage(ServiceMessageIndex::getFlag(valueKey), value->booleanValue);
+			return PVariable(new Variable(VariableType::tVoid));
+		}
 		std::unordered_map<uint32_t, std::unordered_map<std::string, RpcConfigurationParameter>>::iterator channelIterator = valuesCentral.find(channel);
 		if(channelIterator == valuesCentral.end()) return Variable::createError(-2, "Unknown channel.");
 		std::unordered_map<std::string, RpcConfigurationParameter>::iterator parameterIterator = channelIterator->second.find(valueKey);
@@ -1294,13 +1606,14 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 			std::vector<uint8_t> parameterData;
 			rpcParameter->convertToPacket(value, parameter.mainRole(), parameterData);
 			parameter.setBinaryData(parameterData);
-			if(parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-			else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, valueKey, parameterData);
+			invalidateConvertedValue(parameter);
+			saveValue(ParameterGroup::Type::Enum::variables, channel, valueKey, parameterData);
 			if(!valueKeys->empty())
 			{
-				std::string address(_serialNumber + ":" + std::to_string(channel));
+				//Coalesced device updates are older than the value set here
+				if(_eventEnvelope.coalescing()) raiseCoalescedEvents(true);
 				raiseEvent(clientInfo->initInterfaceId, _peerID, channel, valueKeys, values);
-				raiseRPCEvent(clientInfo->initInterfaceId, _peerID, channel, address, valueKeys, values);
+				raiseRPCEvent(clientInfo->initInterfaceId, _peerID, channel, _eventEnvelope.address(channel), valueKeys, values);
 			}
 			return PVariable(new Variable(VariableType::tVoid));
 		}
@@ -1337,11 +1650,15 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 		PacketsById::iterator packetIterator = _rpcDevice->packetsById.find(setRequest);
 		if(packetIterator == _rpcDevice->packetsById.end()) return Variable::createError(-6, "No frame was found for parameter " + valueKey);
 		PPacket frame = packetIterator->second;
+		const std::vector<ParameterIndex::Payload>* indexedPayloads = _parameterIndex ? _parameterIndex->getPayloads(frame.get()) : nullptr;
+		//Frames which are not indexed are built by looking up the parameters by name
+		if(indexedPayloads && indexedPayloads->size() != frame->binaryPayloads.size()) indexedPayloads = nullptr;
+		uint32_t valueIndex = indexedPayloads ? _parameterIndex->getIndex(valueKey) : ParameterIndex::noParameter;
 		std::vector<uint8_t> parameterData;
 		rpcParameter->convertToPacket(value, parameter.mainRole(), parameterData);
 		parameter.setBinaryData(parameterData);
-		if(parameter.databaseId > 0) saveParameter(parameter.databaseId, parameterData);
-		else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, valueKey, parameterData);
+		invalidateConvertedValue(parameter);
+		saveValue(ParameterGroup::Type::Enum::variables, channel, valueKey, parameterData);
 		if(_bl->debugLevel > 4) GD::out.printDebug("Debug: " + valueKey + " of peer " + std::to_string(_peerID) + " with serial number " + _serialNumber + ":" + std::to_string(channel) + " was set to " + BaseLib::HelperFunctions::getHexString(parameterData) + ".");
 
 		std::shared_ptr<MAXCentral> central = std::dynamic_pointer_cast<MAXCentral>(getCentral());
@@ -1360,9 +1677,10 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 			while((signed)payload.size() - 1 < frame->channelIndex - 9) payload.push_back(0);
 			payload.at(frame->channelIndex - 9) = (uint8_t)channel;
 		}
-		std::shared_ptr<MAXPacket> packet(new MAXPacket(_messageCounter, (uint8_t)frame->type, frame->subtype, getCentral()->getAddress(), _address, payload, getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio));
+		std::shared_ptr<MAXPacket> packet(new MAXPacket(_messageCounter.next(), (uint8_t)frame->type, frame->subtype, getCentral()->getAddress(), _address, payload, getRXModes() & HomegearDevice::ReceiveModes::Enum::wakeOnRadio));
 
-		for(BinaryPayloads::iterator i = frame->binaryPayloads.begin(); i != frame->binaryPayloads.end(); ++i)
+		uint32_t payloadIndex = 0;
+		for(BinaryPayloads::iterator i = frame->binaryPayloads.begin(); i != frame->binaryPayloads.end(); ++i, ++payloadIndex)
 		{
 			if((*i)->constValueInteger > -1)
 			{
@@ -1371,11 +1689,20 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 				packet->setPosition((*i)->index, (*i)->size, data);
 				continue;
 			}
+			const ParameterIndex::Payload* indexedPayload = indexedPayloads ? &indexedPayloads->at(payloadIndex) : nullptr;
 			BaseLib::Systems::RpcConfigurationParameter* additionalParameter = nullptr;
 			//We can't just search for param, because it is ambiguous (see for example LEVEL for HM-CC-TC.
-			if((*i)->parameterId == "ON_TIME" && valuesCentral[channel].find((*i)->parameterId) != valuesCentral[channel].end())
+			if(indexedPayload)
+			{
+				if(indexedPayload->onTime) additionalParameter = getValueByIndex(channel, indexedPayload->parameterIndex);
+			}
+			else if((*i)->parameterId == "ON_TIME")
+			{
+				auto onTimeIterator = valuesCentral[channel].find((*i)->parameterId);
+				if(onTimeIterator != valuesCentral[channel].end()) additionalParameter = &onTimeIterator->second;
+			}
+			if(additionalParameter)
 			{
-				additionalParameter = &valuesCentral[channel][(*i)->parameterId];
 				std::vector<uint8_t> parameterData = additionalParameter->getBinaryData();
 				int32_t intValue = 0;
 				_bl->hf.memcpyBigEndian(intValue, parameterData);
@@ -1386,29 +1713,47 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 				}
 			}
 			//param sometimes is ambiguous (e. g. LEVEL of HM-CC-TC), so don't search and use the given parameter when possible
-			else if((*i)->parameterId == rpcParameter->physical->groupId)
+			else if(indexedPayload ? _parameterIndex->getGroup(channel, valueIndex) == indexedPayload->groupIndex : (*i)->parameterId == rpcParameter->physical->groupId)
 			{
-				std::vector<uint8_t> data = valuesCentral[channel][valueKey].getBinaryData();
+				std::vector<uint8_t> data = parameter.getBinaryData();
                 if((*i)->index2Offset != -1 && data.size() == 1) data.at(0) = data.at(0) >> (*i)->index2Offset;
-				packet->setPosition((*i)->index, (*i)->size, data);
+				if(indexedPayload && indexedPayload->insert) packet->setPosition(indexedPayload->insert, data);
+				else packet->setPosition((*i)->index, (*i)->size, data);
 			}
 			//Search for all other parameters
 			else
 			{
-				bool paramFound = false;
-				for(std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator j = valuesCentral[channel].begin(); j != valuesCentral[channel].end(); ++j)
+				BaseLib::Systems::RpcConfigurationParameter* groupParameter = nullptr;
+				if(indexedPayload)
 				{
-					//Only compare id. Till now looking for value_id was not necessary.
-					if((*i)->parameterId == j->second.rpcParameter->physical->groupId)
+					for(std::vector<uint32_t>::const_iterator j = indexedPayload->groupParameters.begin(); j != indexedPayload->groupParameters.end(); ++j)
 					{
-						std::vector<uint8_t> data = j->second.getBinaryData();
-                        if((*i)->index2Offset != -1 && data.size() == 1) data.at(0) = data.at(0) >> (*i)->index2Offset;
-						packet->setPosition((*i)->index, (*i)->size, data);
-						paramFound = true;
-						break;
+						//The group IDs of a parameter can differ between channels
+						if(_parameterIndex->getGroup(channel, *j) != indexedPayload->groupIndex) continue;
+						groupParameter = getValueByIndex(channel, *j);
+						if(groupParameter) break;
 					}
 				}
-				if(!paramFound) GD::out.printError("Error constructing packet. param \"" + (*i)->parameterId + "\" not found. Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frame->id);
+				else
+				{
+					for(std::unordered_map<std::string, BaseLib::Systems::RpcConfigurationParameter>::iterator j = valuesCentral[channel].begin(); j != valuesCentral[channel].end(); ++j)
+					{
+						//Only compare id. Till now looking for value_id was not necessary.
+						if(j->second.rpcParameter && (*i)->parameterId == j->second.rpcParameter->physical->groupId)
+						{
+							groupParameter = &j->second;
+							break;
+						}
+					}
+				}
+				if(groupParameter)
+				{
+					std::vector<uint8_t> data = groupParameter->getBinaryData();
+                    if((*i)->index2Offset != -1 && data.size() == 1) data.at(0) = data.at(0) >> (*i)->index2Offset;
+					if(indexedPayload && indexedPayload->insert) packet->setPosition(indexedPayload->insert, data);
+					else packet->setPosition((*i)->index, (*i)->size, data);
+				}
+				else GD::out.printError("Error constructing packet. param \"" + (*i)->parameterId + "\" not found. Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frame->id);
 			}
 		}
 		if(!rpcParameter->setPackets.front()->autoReset.empty())
@@ -1423,8 +1768,8 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 				if(!tempParam.equals(defaultValue))
 				{
 					tempParam.setBinaryData(defaultValue);
-					if(tempParam.databaseId > 0) saveParameter(tempParam.databaseId, defaultValue);
-					else saveParameter(0, ParameterGroup::Type::Enum::variables, channel, valueKey, defaultValue);
+					invalidateConvertedValue(tempParam);
+					saveValue(ParameterGroup::Type::Enum::variables, channel, *j, defaultValue);
 					GD::out.printInfo( "Info: Parameter \"" + *j + "\" was reset to " + BaseLib::HelperFunctions::getHexString(defaultValue) + ". Peer: " + std::to_string(_peerID) + " Serial number: " + _serialNumber + " Frame: " + frame->id);
 					if(rpcParameter->readable)
 					{
@@ -1434,7 +1779,6 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 				}
 			}
 		}
-		setMessageCounter(_messageCounter + 1);
 		queue->parameterName = valueKey;
 		queue->channel = channel;
 		queue->push(packet);
@@ -1446,9 +1790,10 @@ PVariable MAXPeer::setValue(BaseLib::PRpcClientInfo clientInfo, uint32_t channel
 
 		if(!valueKeys->empty())
 		{
-			std::string address(_serialNumber + ":" + std::to_string(channel));
+			//Coalesced device updates are older than the value set here
+			if(_eventEnvelope.coalescing()) raiseCoalescedEvents(true);
 			raiseEvent(clientInfo->initInterfaceId, _peerID, channel, valueKeys, values);
-			raiseRPCEvent(clientInfo->initInterfaceId, _peerID, channel, address, valueKeys, values);
+			raiseRPCEvent(clientInfo->initInterfaceId, _peerID, channel, _eventEnvelope.address(channel), valueKeys, values);
 		}
 
 		return std::make_shared<Variable>(VariableType::tVoid);
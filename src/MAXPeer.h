@@ -33,8 +33,13 @@
 #include <homegear-base/BaseLib.h>
 #include "MAXPacket.h"
 #include "PendingQueues.h"
+#include "ParameterIndex.h"
+#include "MessageCounter.h"
+#include "EventEnvelope.h"
+#include "ServiceMessageIndex.h"
 
 #include <list>
+#include <shared_mutex>
 
 using namespace BaseLib;
 using namespace BaseLib::DeviceDescription;
@@ -44,22 +49,6 @@ namespace MAX
 {
 class MAXCentral;
 
-class FrameValue
-{
-public:
-	std::list<uint32_t> channels;
-	std::vector<uint8_t> value;
-};
-
-class FrameValues
-{
-public:
-	std::string frameID;
-	std::list<uint32_t> paramsetChannels;
-	ParameterGroup::Type::Enum parameterSetType;
-	std::map<std::string, FrameValue> values;
-};
-
 class MAXPeer : public BaseLib::Systems::Peer
 {
 public:
@@ -74,8 +63,7 @@ public:
 	//End features
 
 	//In table variables:
-	int32_t getMessageCounter() { return _messageCounter; }
-	void setMessageCounter(int32_t value) { _messageCounter = value; saveVariable(5, value); }
+	int32_t getMessageCounter() { return _messageCounter.current(); }
 	std::string getPhysicalInterfaceID() { return _physicalInterfaceID; }
 	void setPhysicalInterfaceID(std::string);
 	//End
@@ -83,9 +71,28 @@ public:
 	std::shared_ptr<PendingQueues> pendingQueues;
 
 	virtual void worker();
+	int64_t getNextWorkerRun();
+	//Creates missing config parameters and values like BaseLib does and rebuilds the value index afterwards. Not thread
+	//safe. Only call this before the peer is published to the central.
+	virtual void initializeCentralConfig();
+	//Not thread safe. Only call this before the peer is published to the central.
+	void indexValues();
+	//Service message changes which need to be reflected in the central's service message index go through these methods.
+	void setConfigPending(bool value);
+	void setUnreach(bool value, bool requeue);
+	void endUnreach();
+	void indexServiceMessage(ServiceMessageIndex::Flag flag, bool value);
+	void indexServiceMessages();
+	//Removes the peer from the central's service message index. Later calls of indexServiceMessage() are ignored.
+	void removeFromServiceMessageIndex();
+	//Writes a parameter to the database immediately. Use saveValue() to write through the central's write buffer.
+	void persistParameter(ParameterGroup::Type::Enum type, uint32_t channel, const std::string& parameterId, std::vector<uint8_t>& value);
+	//Called by BaseLib's service messages when they change UNREACH, STICKY_UNREACH, CONFIG_PENDING, LOWBAT, ...
+	virtual void onSaveParameter(std::string name, uint32_t channel, std::vector<uint8_t>& data);
 	virtual std::string handleCliCommand(std::string command);
 
 	virtual bool load(BaseLib::Systems::ICentral* central);
+	bool load(BaseLib::Systems::ICentral* central, std::shared_ptr<BaseLib::Database::DataTable> variableRows);
 	virtual void save(bool savePeer, bool saveVariables, bool saveCentralConfig);
     void serializePeers(std::vector<uint8_t>& encodedData);
     void unserializePeers(std::shared_ptr<std::vector<char>> serializedData);
@@ -103,11 +110,14 @@ public:
 
     std::shared_ptr<IPhysicalInterface> getPhysicalInterface() { return _physicalInterface; }
     void setRSSIDevice(uint8_t rssi);
-	void getValuesFromPacket(std::shared_ptr<MAXPacket> packet, std::vector<FrameValues>& frameValue);
+	void getValuesFromPacket(std::shared_ptr<MAXPacket> packet, DecodeResult& result);
 	void packetReceived(std::shared_ptr<MAXPacket> packet);
 	void sendTime();
 
 	//RPC methods
+	virtual PVariable getAllConfig(BaseLib::PRpcClientInfo clientInfo);
+	//All readable variables by channel, served from the converted value cache
+	PVariable getCachedValues(BaseLib::PRpcClientInfo clientInfo);
 	virtual PVariable getDeviceInfo(BaseLib::PRpcClientInfo clientInfo, std::map<std::string, bool> fields);
 	virtual PVariable getParamsetDescription(BaseLib::PRpcClientInfo clientInfo, int32_t channel, ParameterGroup::Type::Enum type, uint64_t remoteID, int32_t remoteChannel, bool checkAcls);
 	virtual PVariable getParamset(BaseLib::PRpcClientInfo clientInfo, int32_t channel, ParameterGroup::Type::Enum type, uint64_t remoteID, int32_t remoteChannel, bool checkAcls);
@@ -121,9 +131,33 @@ protected:
 	int64_t _lastTimePacket = 0;
 	int32_t _randomSleep = 0;
 	int32_t _lastReceivedMessageCounter = -1;
+	std::shared_ptr<ParameterIndex> _parameterIndex;
+	//Indexed by channel, then by interned parameter ID. Points to the elements in valuesCentral. std::unordered_map never
+	//moves its elements, so the pointers stay valid as long as no value is erased. Variables are never erased while the
+	//peer exists. valuesCentral is only rebuilt by initializeCentralConfig(), which reindexes. Values created in
+	//valuesCentral after indexValues() are added by indexValue().
+	std::vector<std::vector<std::atomic<RpcConfigurationParameter*>>> _valuesByIndex;
+	uint32_t _rssiDeviceIndex = ParameterIndex::noParameter;
+	EventEnvelope _eventEnvelope;
+	//Bit n is set when flag n is set in the central's service message index
+	//Written together with the central's index while _serviceMessageIndexMutex is held
+	std::mutex _serviceMessageIndexMutex;
+	bool _serviceMessageIndexRemoved = false;
+	std::atomic<uint32_t> _serviceMessageFlags{0};
+	//Serializes database writes of parameters, so the row of a parameter is only inserted once (see persistParameter())
+	std::mutex _databaseIdMutex;
+	//MAXCentral::loadPeers() loads peers in parallel. BaseLib's Peer, the device descriptions and the database controller
+	//don't guarantee thread safety, so load() holds this mutex while calling them.
+	static std::mutex _loadMutex;
+	//Converted values of variables. An entry is removed whenever the binary data of its parameter changes.
+	std::mutex _convertedValuesMutex;
+	std::unordered_map<const RpcConfigurationParameter*, PVariable> _convertedValues;
+
+	//Held exclusively while putParamset modifies configCentral. getParamset, getAllConfig and printConfig hold it shared.
+	std::shared_mutex _configMutex;
 
 	//In table variables:
-	uint8_t _messageCounter = 0;
+	MessageCounter _messageCounter;
 	std::string _physicalInterfaceID;
 	//End
 
@@ -133,6 +167,15 @@ protected:
 
 	virtual PParameterGroup getParameterSet(int32_t channel, ParameterGroup::Type::Enum type);
 
+	RpcConfigurationParameter* getValueByIndex(uint32_t channel, uint32_t index) { return (channel < _valuesByIndex.size() && index < _valuesByIndex[channel].size()) ? _valuesByIndex[channel][index].load() : nullptr; }
+	void indexValue(uint32_t channel, uint32_t index, RpcConfigurationParameter* parameter) { if(channel < _valuesByIndex.size() && index < _valuesByIndex[channel].size()) _valuesByIndex[channel][index].store(parameter); }
+	//Returns a copy of the cached value. Service messages are not cached, BaseLib changes them without notice.
+	PVariable getConvertedValue(RpcConfigurationParameter& parameter, const PParameter& rpcParameter);
+	void invalidateConvertedValue(const RpcConfigurationParameter& parameter);
+	//Raises the coalesced events whose window has passed or all of them when "all" is true.
+	void raiseCoalescedEvents(bool all);
+	void saveValue(ParameterGroup::Type::Enum type, uint32_t channel, const std::string& parameterId, std::vector<uint8_t>& value);
+
 	virtual void loadVariables(BaseLib::Systems::ICentral* central, std::shared_ptr<BaseLib::Database::DataTable>& rows);
     virtual void saveVariables();
 };
@@ -0,0 +1,98 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "MessageCounter.h"
+#include "GD.h"
+
+namespace MAX
+{
+MessageCounter::MessageCounter()
+{
+	_value = 0;
+	_leaseEnd = 0;
+	_persistedLeaseEnd = 0;
+}
+
+void MessageCounter::init(int32_t leaseSize, LeaseHandler leaseHandler)
+{
+	try
+	{
+		std::lock_guard<std::mutex> leaseGuard(_leaseMutex);
+		if(leaseSize <= 0) leaseSize = 16;
+		else if(leaseSize > (signed)_maxLeaseSize) leaseSize = _maxLeaseSize;
+		_leaseSize = leaseSize;
+		_leaseHandler = leaseHandler;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void MessageCounter::load(uint8_t leaseEnd)
+{
+	try
+	{
+		std::lock_guard<std::mutex> leaseGuard(_leaseMutex);
+		_value = leaseEnd;
+		_leaseEnd = leaseEnd;
+		_persistedLeaseEnd = leaseEnd;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+uint8_t MessageCounter::next()
+{
+	uint64_t value = _value.fetch_add(1);
+	try
+	{
+		if(value >= _leaseEnd.load())
+		{
+			std::lock_guard<std::mutex> leaseGuard(_leaseMutex);
+			//Another thread might have taken a new lease in the meantime.
+			if(value >= _leaseEnd.load())
+			{
+				uint64_t leaseEnd = value + _leaseSize;
+				_persistedLeaseEnd = leaseEnd;
+				if(_leaseHandler) _leaseHandler((uint8_t)(leaseEnd & 0xFF));
+				_leaseEnd = leaseEnd;
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return (uint8_t)(value & 0xFF);
+}
+
+}
@@ -0,0 +1,74 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef MESSAGECOUNTER_H_
+#define MESSAGECOUNTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+namespace MAX
+{
+
+//Hands out message counters from a block of values reserved ("leased") in the database. Only the end of the lease is
+//persisted, so a counter is written once per block instead of once per packet. After a restart counting continues at the
+//end of the last lease, so no counter is reused.
+class MessageCounter
+{
+public:
+	//Called with the new lease end before any counter of the lease is handed out. Needs to persist the value.
+	typedef std::function<void(uint8_t leaseEnd)> LeaseHandler;
+
+	MessageCounter();
+	virtual ~MessageCounter() {}
+
+	void init(int32_t leaseSize, LeaseHandler leaseHandler);
+	//Continues counting at the persisted lease end. The next call to next() takes a new lease.
+	void load(uint8_t leaseEnd);
+	uint8_t next();
+	uint8_t current() { return (uint8_t)(_value.load() & 0xFF); }
+	//The lease end currently stored in the database
+	uint8_t leaseEnd() { return (uint8_t)(_persistedLeaseEnd.load() & 0xFF); }
+protected:
+	//Counters wrap after 255, so a lease can't be larger than half of the counter space.
+	static const uint32_t _maxLeaseSize = 128;
+
+	std::atomic<uint64_t> _value;
+	//Counters below this value may be handed out without touching the database.
+	std::atomic<uint64_t> _leaseEnd;
+	std::atomic<uint64_t> _persistedLeaseEnd;
+	uint32_t _leaseSize = 16;
+	std::mutex _leaseMutex;
+	LeaseHandler _leaseHandler;
+};
+
+}
+#endif
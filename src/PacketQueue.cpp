@@ -589,7 +589,7 @@ void PacketQueue::send(std::shared_ptr<MAXPacket> packet, bool stealthy)
 	try
 	{
 		if(noSending || _disposing) return;
-		if(packet->getBurst()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		//The gap before bursts is kept by the physical interface
 		std::shared_ptr<MAXCentral> central(std::dynamic_pointer_cast<MAXCentral>(GD::family->getCentral()));
 		if(central) central->sendPacket(_physicalInterface, packet, stealthy);
 		else GD::out.printError("Error: Central pointer of queue " + std::to_string(id) + " is null.");
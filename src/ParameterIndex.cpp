@@ -0,0 +1,199 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "ParameterIndex.h"
+#include "GD.h"
+
+#include <algorithm>
+
+namespace MAX
+{
+std::mutex ParameterIndex::_cacheMutex;
+std::unordered_map<const BaseLib::DeviceDescription::HomegearDevice*, std::shared_ptr<ParameterIndex>> ParameterIndex::_cache;
+
+ParameterIndex::ParameterIndex(BaseLib::DeviceDescription::PHomegearDevice device) : _device(device)
+{
+	try
+	{
+		if(!_device || _device->functions.empty()) return;
+
+		uint32_t channelCount = _device->functions.rbegin()->first + 1;
+		std::vector<BaseLib::DeviceDescription::PParameter> variables;
+		for(auto& function : _device->functions)
+		{
+			BaseLib::DeviceDescription::PParameterGroup parameterGroup = function.second->getParameterGroup(BaseLib::DeviceDescription::ParameterGroup::Type::Enum::variables);
+			if(parameterGroup)
+			{
+				for(auto& parameter : parameterGroup->parameters)
+				{
+					addIndex(parameter.first);
+					variables.push_back(parameter.second);
+				}
+			}
+			parameterGroup = function.second->getParameterGroup(BaseLib::DeviceDescription::ParameterGroup::Type::Enum::config);
+			if(parameterGroup)
+			{
+				for(auto& parameter : parameterGroup->parameters) addIndex(parameter.first);
+			}
+		}
+
+		_variables.resize(channelCount, std::vector<bool>(_names.size(), false));
+		_config.resize(channelCount, std::vector<bool>(_names.size(), false));
+		_groups.resize(channelCount, std::vector<uint32_t>(_names.size(), noParameter));
+		for(auto& function : _device->functions)
+		{
+			BaseLib::DeviceDescription::PParameterGroup parameterGroup = function.second->getParameterGroup(BaseLib::DeviceDescription::ParameterGroup::Type::Enum::variables);
+			if(parameterGroup)
+			{
+				for(auto& parameter : parameterGroup->parameters)
+				{
+					uint32_t index = _indexes[parameter.first];
+					_variables[function.first][index] = true;
+					if(parameter.second->physical) _groups[function.first][index] = addGroup(parameter.second->physical->groupId);
+				}
+			}
+			parameterGroup = function.second->getParameterGroup(BaseLib::DeviceDescription::ParameterGroup::Type::Enum::config);
+			if(parameterGroup)
+			{
+				for(auto& parameter : parameterGroup->parameters) _config[function.first][_indexes[parameter.first]] = true;
+			}
+		}
+
+		for(auto& frame : _device->packetsById)
+		{
+			if(!frame.second) continue;
+			for(auto& associatedVariable : frame.second->associatedVariables) addIndex(associatedVariable->id);
+			std::vector<Payload>& payloads = _payloads[frame.second.get()];
+			payloads.reserve(frame.second->binaryPayloads.size());
+			BaseLib::DeviceDescription::PPacket packet = frame.second;
+			const FrameFields::Field* generatedFields = FrameFields::getFields(_device, packet);
+			for(auto& binaryPayload : frame.second->binaryPayloads)
+			{
+				Payload payload;
+				if(generatedFields) payload.insert = generatedFields[payloads.size()].insert;
+				payload.onTime = binaryPayload->parameterId == "ON_TIME";
+				payload.parameterIndex = getIndex(binaryPayload->parameterId);
+				payload.groupIndex = addGroup(binaryPayload->parameterId);
+				for(auto& variable : variables)
+				{
+					if(variable->physical->groupId != binaryPayload->parameterId) continue;
+					uint32_t index = _indexes[variable->id];
+					if(std::find(payload.groupParameters.begin(), payload.groupParameters.end(), index) == payload.groupParameters.end()) payload.groupParameters.push_back(index);
+				}
+				payloads.push_back(std::move(payload));
+			}
+		}
+
+		//Associated variables might have added IDs
+		for(auto& channel : _variables) channel.resize(_names.size(), false);
+		for(auto& channel : _config) channel.resize(_names.size(), false);
+		for(auto& channel : _groups) channel.resize(_names.size(), noParameter);
+
+		_serviceFlags.reserve(_names.size());
+		for(auto& name : _names) _serviceFlags.push_back(ServiceMessageIndex::getFlag(name));
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+std::shared_ptr<ParameterIndex> ParameterIndex::get(BaseLib::DeviceDescription::PHomegearDevice device)
+{
+	try
+	{
+		if(!device) return std::shared_ptr<ParameterIndex>();
+		std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+		auto cacheIterator = _cache.find(device.get());
+		if(cacheIterator != _cache.end()) return cacheIterator->second;
+		std::shared_ptr<ParameterIndex> parameterIndex = std::make_shared<ParameterIndex>(device);
+		_cache.emplace(device.get(), parameterIndex);
+		return parameterIndex;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return std::shared_ptr<ParameterIndex>();
+}
+
+void ParameterIndex::clearCache()
+{
+	std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+	_cache.clear();
+}
+
+uint32_t ParameterIndex::addIndex(const std::string& id)
+{
+	auto indexIterator = _indexes.find(id);
+	if(indexIterator != _indexes.end()) return indexIterator->second;
+	uint32_t index = _names.size();
+	_indexes.emplace(id, index);
+	_names.push_back(id);
+	return index;
+}
+
+uint32_t ParameterIndex::addGroup(const std::string& groupId)
+{
+	auto groupIterator = _groupIndexes.find(groupId);
+	if(groupIterator != _groupIndexes.end()) return groupIterator->second;
+	uint32_t index = _groupIndexes.size();
+	_groupIndexes.emplace(groupId, index);
+	return index;
+}
+
+uint32_t ParameterIndex::getIndex(const std::string& id)
+{
+	auto indexIterator = _indexes.find(id);
+	if(indexIterator == _indexes.end()) return noParameter;
+	return indexIterator->second;
+}
+
+bool ParameterIndex::inParameterSet(uint32_t channel, BaseLib::DeviceDescription::ParameterGroup::Type::Enum type, uint32_t index)
+{
+	std::vector<std::vector<bool>>& parameterSets = (type == BaseLib::DeviceDescription::ParameterGroup::Type::Enum::config) ? _config : _variables;
+	if(type != BaseLib::DeviceDescription::ParameterGroup::Type::Enum::config && type != BaseLib::DeviceDescription::ParameterGroup::Type::Enum::variables) return false;
+	if(channel >= parameterSets.size() || index >= parameterSets[channel].size()) return false;
+	return parameterSets[channel][index];
+}
+
+const std::vector<ParameterIndex::Payload>* ParameterIndex::getPayloads(const BaseLib::DeviceDescription::Packet* frame)
+{
+	auto payloadsIterator = _payloads.find(frame);
+	if(payloadsIterator == _payloads.end()) return nullptr;
+	return &payloadsIterator->second;
+}
+
+DecodePlan* ParameterIndex::getDecodePlan()
+{
+	std::call_once(_decodePlanCompiled, [this]() { _decodePlan.reset(new DecodePlan(_device, this)); });
+	return _decodePlan.get();
+}
+
+}
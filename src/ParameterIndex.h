@@ -0,0 +1,110 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef PARAMETERINDEX_H_
+#define PARAMETERINDEX_H_
+
+#include <homegear-base/BaseLib.h>
+#include "DecodePlan.h"
+#include "FrameFields.h"
+#include "ServiceMessageIndex.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MAX
+{
+//Interned parameter IDs of one device description. Every variable and config parameter ID is mapped to a small
+//integer, so values can be stored in arrays and packets can be decoded and encoded without hashing or comparing strings.
+class ParameterIndex
+{
+public:
+	static const uint32_t noParameter = 0xFFFFFFFF;
+
+	//Precomputed information for one binary payload of a frame. Same order as Packet::binaryPayloads.
+	class Payload
+	{
+	public:
+		bool onTime = false;
+		uint32_t parameterIndex = noParameter;
+		//Interned parameter ID of the payload in the group ID space (see getGroup())
+		uint32_t groupIndex = noParameter;
+		//Generated insertion function (see FrameFields.h) or nullptr
+		FrameFields::Insert insert = nullptr;
+		//All variables of the device having the payload's parameter ID as group ID on at least one channel. Check
+		//getGroup() for the channel in question.
+		std::vector<uint32_t> groupParameters;
+	};
+
+	ParameterIndex(BaseLib::DeviceDescription::PHomegearDevice device);
+	virtual ~ParameterIndex() {}
+
+	static std::shared_ptr<ParameterIndex> get(BaseLib::DeviceDescription::PHomegearDevice device);
+	static void clearCache();
+
+	uint32_t size() { return _names.size(); }
+	uint32_t getIndex(const std::string& id);
+	const std::string& getName(uint32_t index) { return _names.at(index); }
+	bool inParameterSet(uint32_t channel, BaseLib::DeviceDescription::ParameterGroup::Type::Enum type, uint32_t index);
+	//Interned group ID of the variable on the given channel or noParameter. Group IDs can differ between channels.
+	uint32_t getGroup(uint32_t channel, uint32_t index) { return (channel < _groups.size() && index < _groups[channel].size()) ? _groups[channel][index] : noParameter; }
+	//The indexed service message a parameter ID belongs to or ServiceMessageIndex::flagCount
+	ServiceMessageIndex::Flag getServiceFlag(uint32_t index) { return index < _serviceFlags.size() ? _serviceFlags[index] : ServiceMessageIndex::flagCount; }
+	const std::vector<Payload>* getPayloads(const BaseLib::DeviceDescription::Packet* frame);
+	//The decode plan is compiled on first use
+	DecodePlan* getDecodePlan();
+protected:
+	static std::mutex _cacheMutex;
+	static std::unordered_map<const BaseLib::DeviceDescription::HomegearDevice*, std::shared_ptr<ParameterIndex>> _cache;
+
+	//Keeps the device description alive, so the frame pointers below stay valid.
+	BaseLib::DeviceDescription::PHomegearDevice _device;
+	std::unordered_map<std::string, uint32_t> _indexes;
+	std::vector<std::string> _names;
+	//Indexed by channel, then by parameter index
+	std::vector<std::vector<bool>> _variables;
+	std::vector<std::vector<bool>> _config;
+	std::unordered_map<std::string, uint32_t> _groupIndexes;
+	//Indexed by channel, then by parameter index
+	std::vector<std::vector<uint32_t>> _groups;
+	std::vector<ServiceMessageIndex::Flag> _serviceFlags;
+	std::unordered_map<const BaseLib::DeviceDescription::Packet*, std::vector<Payload>> _payloads;
+	std::once_flag _decodePlanCompiled;
+	std::unique_ptr<DecodePlan> _decodePlan;
+
+	uint32_t addIndex(const std::string& id);
+	uint32_t addGroup(const std::string& groupId);
+};
+
+}
+
+#endif
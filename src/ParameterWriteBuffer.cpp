@@ -0,0 +1,197 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "ParameterWriteBuffer.h"
+#include "MAXCentral.h"
+#include "GD.h"
+
+namespace MAX
+{
+ParameterWriteBuffer::ParameterWriteBuffer()
+{
+	_started = false;
+	_flushLag = 0;
+	_flushedParameters = 0;
+}
+
+ParameterWriteBuffer::~ParameterWriteBuffer()
+{
+	stopThread();
+}
+
+void ParameterWriteBuffer::start(MAXCentral* central, uint32_t flushInterval, uint32_t flushSize)
+{
+	try
+	{
+		if(_started || !central || flushInterval == 0) return;
+		_central = central;
+		_flushInterval = flushInterval;
+		_flushSize = flushSize == 0 ? 1 : flushSize;
+		{
+			std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+			_stopThread = false;
+		}
+		GD::bl->threadManager.start(_flushThread, true, &ParameterWriteBuffer::flushThread, this);
+		_started = true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void ParameterWriteBuffer::stop()
+{
+	stopThread();
+	flush();
+}
+
+void ParameterWriteBuffer::stopThread()
+{
+	try
+	{
+		_started = false;
+		{
+			std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+			_stopThread = true;
+		}
+		_entriesConditionVariable.notify_all();
+		GD::bl->threadManager.join(_flushThread);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool ParameterWriteBuffer::enqueue(uint64_t peerId, BaseLib::DeviceDescription::ParameterGroup::Type::Enum type, uint32_t channel, const std::string& parameterId, const std::vector<uint8_t>& value)
+{
+	try
+	{
+		if(!_started) return false;
+		Key key;
+		key.peerId = peerId;
+		key.type = (int32_t)type;
+		key.channel = channel;
+		key.parameterId = parameterId;
+		bool flushNow = false;
+		{
+			std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+			if(_stopThread) return false;
+			auto entryIterator = _entries.emplace(std::move(key), Entry());
+			//Keep the time of the first write, so the flush lag includes coalesced writes
+			if(entryIterator.second) entryIterator.first->second.time = BaseLib::HelperFunctions::getTime();
+			entryIterator.first->second.value = value;
+			flushNow = _entries.size() >= _flushSize;
+		}
+		if(flushNow) _entriesConditionVariable.notify_one();
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+void ParameterWriteBuffer::discard(uint64_t peerId)
+{
+	try
+	{
+		std::lock_guard<std::mutex> flushGuard(_flushMutex);
+		std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+		for(auto i = _entries.begin(); i != _entries.end();)
+		{
+			if(i->first.peerId == peerId) i = _entries.erase(i);
+			else ++i;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+uint32_t ParameterWriteBuffer::queueDepth()
+{
+	std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+	return _entries.size();
+}
+
+void ParameterWriteBuffer::flush()
+{
+	try
+	{
+		std::lock_guard<std::mutex> flushGuard(_flushMutex);
+		std::unordered_map<Key, Entry, KeyHash> entries;
+		{
+			std::lock_guard<std::mutex> entriesGuard(_entriesMutex);
+			entries.swap(_entries);
+		}
+		if(entries.empty() || !_central) return;
+
+		int64_t oldestEntry = 0;
+		for(auto& entry : entries)
+		{
+			if(oldestEntry == 0 || entry.second.time < oldestEntry) oldestEntry = entry.second.time;
+			std::shared_ptr<MAXPeer> peer = _central->getPeer(entry.first.peerId);
+			if(!peer) continue;
+			peer->persistParameter((BaseLib::DeviceDescription::ParameterGroup::Type::Enum)entry.first.type, entry.first.channel, entry.first.parameterId, entry.second.value);
+		}
+		_flushLag = BaseLib::HelperFunctions::getTime() - oldestEntry;
+		_flushedParameters += entries.size();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void ParameterWriteBuffer::flushThread()
+{
+	std::unique_lock<std::mutex> entriesGuard(_entriesMutex);
+	while(!_stopThread)
+	{
+		try
+		{
+			_entriesConditionVariable.wait_for(entriesGuard, std::chrono::milliseconds(_flushInterval), [&] { return _stopThread || _entries.size() >= _flushSize; });
+			if(_stopThread || _entries.empty()) continue;
+			entriesGuard.unlock();
+			flush();
+			entriesGuard.lock();
+		}
+		catch(const std::exception& ex)
+		{
+			if(!entriesGuard.owns_lock()) entriesGuard.lock();
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+	}
+}
+
+}
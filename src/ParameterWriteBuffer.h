@@ -0,0 +1,116 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef PARAMETERWRITEBUFFER_H_
+#define PARAMETERWRITEBUFFER_H_
+
+#include <homegear-base/BaseLib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace MAX
+{
+class MAXCentral;
+
+//Write-behind buffer for peer parameters. Repeated writes to the same parameter are coalesced and written by a separate
+//thread once the flush interval has passed or the buffer holds flushSize parameters.
+class ParameterWriteBuffer
+{
+public:
+	ParameterWriteBuffer();
+	virtual ~ParameterWriteBuffer();
+
+	void start(MAXCentral* central, uint32_t flushInterval, uint32_t flushSize);
+	//Stops the flush thread and writes all remaining parameters.
+	void stop();
+
+	//Returns false when the buffer is not running and the caller needs to write the parameter itself.
+	bool enqueue(uint64_t peerId, BaseLib::DeviceDescription::ParameterGroup::Type::Enum type, uint32_t channel, const std::string& parameterId, const std::vector<uint8_t>& value);
+	//Drops all buffered parameters of a peer, e. g. when it is deleted.
+	void discard(uint64_t peerId);
+	void flush();
+
+	uint32_t queueDepth();
+	//Time in milliseconds the oldest parameter of the last flush waited to be written
+	int64_t flushLag() { return _flushLag; }
+	uint64_t flushedParameters() { return _flushedParameters; }
+protected:
+	//Parameters are identified by parameter set type, channel and ID. The database ID is not part of the key: it is
+	//assigned by the first write, so writes before and after it would not be coalesced. The peer resolves it when the
+	//parameter is written.
+	class Key
+	{
+	public:
+		uint64_t peerId = 0;
+		int32_t type = 0;
+		uint32_t channel = 0;
+		std::string parameterId;
+
+		bool operator==(const Key& rhs) const { return peerId == rhs.peerId && type == rhs.type && channel == rhs.channel && parameterId == rhs.parameterId; }
+	};
+
+	class KeyHash
+	{
+	public:
+		size_t operator()(const Key& key) const { return std::hash<std::string>()(key.parameterId) ^ (std::hash<uint64_t>()(key.peerId) << 1) ^ ((size_t)key.channel << 8) ^ ((size_t)key.type << 16); }
+	};
+
+	class Entry
+	{
+	public:
+		std::vector<uint8_t> value;
+		int64_t time = 0;
+	};
+
+	MAXCentral* _central = nullptr;
+	std::atomic_bool _started;
+	bool _stopThread = false;
+	uint32_t _flushInterval = 1000;
+	uint32_t _flushSize = 200;
+	std::mutex _entriesMutex;
+	std::condition_variable _entriesConditionVariable;
+	std::unordered_map<Key, Entry, KeyHash> _entries;
+	//Held while parameters are written, so discard() can't miss parameters of a flush in progress.
+	std::mutex _flushMutex;
+	std::thread _flushThread;
+	std::atomic<int64_t> _flushLag;
+	std::atomic<uint64_t> _flushedParameters;
+
+	void stopThread();
+	void flushThread();
+};
+
+}
+#endif
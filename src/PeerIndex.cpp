@@ -0,0 +1,196 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "PeerIndex.h"
+#include "GD.h"
+
+namespace MAX
+{
+PeerIndex::PeerIndex()
+{
+	_snapshot = new Snapshot();
+	_epoch = 0;
+	_readers[0] = 0;
+	_readers[1] = 0;
+}
+
+PeerIndex::~PeerIndex()
+{
+	delete _snapshot.exchange(nullptr);
+	for(auto& retired : _retired)
+	{
+		delete retired.first;
+	}
+}
+
+PeerIndex::Snapshot* PeerIndex::enter(uint32_t& epoch)
+{
+	epoch = _epoch.load() & 1;
+	_readers[epoch]++;
+	return _snapshot.load();
+}
+
+void PeerIndex::leave(uint32_t epoch)
+{
+	_readers[epoch]--;
+}
+
+void PeerIndex::reclaimRetired()
+{
+	if(_retired.empty()) return;
+	//Readers are in the current epoch or the one before. Once the counter of the one before is zero, the epoch advances
+	//and new readers reuse that counter. A snapshot retired in epoch n can only be seen by readers of epoch n - 1 and n,
+	//so it is unreachable when epoch n + 2 is reached.
+	for(int32_t i = 0; i < 2; i++)
+	{
+		uint32_t epoch = _epoch.load();
+		if(_readers[(epoch + 1) & 1].load() != 0) break;
+		_epoch.store(epoch + 1);
+	}
+	uint32_t epoch = _epoch.load();
+	for(auto i = _retired.begin(); i != _retired.end();)
+	{
+		if(epoch - i->second >= 2)
+		{
+			delete i->first;
+			i = _retired.erase(i);
+		}
+		else ++i;
+	}
+}
+
+std::shared_ptr<MAXPeer> PeerIndex::get(int32_t address)
+{
+	uint32_t epoch = 0;
+	Snapshot* snapshot = enter(epoch);
+	std::shared_ptr<MAXPeer> peer;
+	if(snapshot)
+	{
+		auto peerIterator = snapshot->peersByAddress.find(address);
+		if(peerIterator != snapshot->peersByAddress.end()) peer = peerIterator->second;
+	}
+	leave(epoch);
+	return peer;
+}
+
+std::shared_ptr<MAXPeer> PeerIndex::get(uint64_t id)
+{
+	uint32_t epoch = 0;
+	Snapshot* snapshot = enter(epoch);
+	std::shared_ptr<MAXPeer> peer;
+	if(snapshot)
+	{
+		auto peerIterator = snapshot->peersById.find(id);
+		if(peerIterator != snapshot->peersById.end()) peer = peerIterator->second;
+	}
+	leave(epoch);
+	return peer;
+}
+
+std::shared_ptr<MAXPeer> PeerIndex::get(const std::string& serialNumber)
+{
+	uint32_t epoch = 0;
+	Snapshot* snapshot = enter(epoch);
+	std::shared_ptr<MAXPeer> peer;
+	if(snapshot)
+	{
+		auto peerIterator = snapshot->peersBySerial.find(serialNumber);
+		if(peerIterator != snapshot->peersBySerial.end()) peer = peerIterator->second;
+	}
+	leave(epoch);
+	return peer;
+}
+
+std::vector<std::shared_ptr<MAXPeer>> PeerIndex::getAll()
+{
+	std::vector<std::shared_ptr<MAXPeer>> peers;
+	uint32_t epoch = 0;
+	Snapshot* snapshot = enter(epoch);
+	try
+	{
+		if(snapshot)
+		{
+			peers.reserve(snapshot->peersById.size());
+			for(auto& peer : snapshot->peersById)
+			{
+				peers.push_back(peer.second);
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	leave(epoch);
+	return peers;
+}
+
+size_t PeerIndex::size()
+{
+	uint32_t epoch = 0;
+	Snapshot* snapshot = enter(epoch);
+	size_t size = snapshot ? snapshot->peersById.size() : 0;
+	leave(epoch);
+	return size;
+}
+
+void PeerIndex::publish(std::unique_ptr<Snapshot> snapshot)
+{
+	try
+	{
+		std::lock_guard<std::mutex> writeGuard(_writeMutex);
+		Snapshot* oldSnapshot = _snapshot.exchange(snapshot.release());
+		if(oldSnapshot) _retired.emplace_back(oldSnapshot, _epoch.load());
+		reclaimRetired();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void PeerIndex::clear()
+{
+	publish(std::unique_ptr<Snapshot>(new Snapshot()));
+}
+
+void PeerIndex::reclaim()
+{
+	try
+	{
+		std::lock_guard<std::mutex> writeGuard(_writeMutex);
+		reclaimRetired();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+}
@@ -0,0 +1,89 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef PEERINDEX_H_
+#define PEERINDEX_H_
+
+#include "MAXPeer.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MAX
+{
+//Immutable peer lookup tables. Readers never take a lock: They register in the reader counter of the current epoch, read
+//the current snapshot and leave again. Writers build a complete new snapshot and swap it in. The old one is retired and
+//freed after a grace period: The epoch only advances when the counter of the epoch before is zero, and two advances
+//after a snapshot was retired no reader can still see it (as in userspace RCU). Writers never wait for readers.
+class PeerIndex
+{
+public:
+	class Snapshot
+	{
+	public:
+		std::unordered_map<int32_t, std::shared_ptr<MAXPeer>> peersByAddress;
+		std::unordered_map<uint64_t, std::shared_ptr<MAXPeer>> peersById;
+		std::unordered_map<std::string, std::shared_ptr<MAXPeer>> peersBySerial;
+	};
+
+	PeerIndex();
+	virtual ~PeerIndex();
+
+	std::shared_ptr<MAXPeer> get(int32_t address);
+	std::shared_ptr<MAXPeer> get(uint64_t id);
+	std::shared_ptr<MAXPeer> get(const std::string& serialNumber);
+	std::vector<std::shared_ptr<MAXPeer>> getAll();
+	size_t size();
+
+	void publish(std::unique_ptr<Snapshot> snapshot);
+	void clear();
+	//Frees retired snapshots whose grace period has passed. Called on every publish and regularly by the central's worker
+	//thread, so snapshots don't linger when nothing is published.
+	void reclaim();
+protected:
+	std::atomic<Snapshot*> _snapshot;
+	std::atomic<uint32_t> _epoch;
+	std::atomic<uint32_t> _readers[2];
+	//Guards the epoch advances and _retired
+	std::mutex _writeMutex;
+	//Snapshots replaced by publish() and the epoch at the time they were replaced
+	std::vector<std::pair<Snapshot*, uint32_t>> _retired;
+
+	Snapshot* enter(uint32_t& epoch);
+	void leave(uint32_t epoch);
+	//_writeMutex needs to be locked
+	void reclaimRetired();
+};
+
+}
+#endif
@@ -218,7 +218,7 @@ void PendingQueues::remove(std::string parameterName, int32_t channel)
     _queuesMutex.unlock();
 }
 
-bool PendingQueues::exists(std::string parameterName, int32_t channel)
+bool PendingQueues::exists(const std::string& parameterName, int32_t channel)
 {
 	try
 	{
@@ -232,7 +232,7 @@ bool PendingQueues::exists(std::string parameterName, int32_t channel)
 		for(int32_t i = _queues.size() - 1; i >= 0; i--)
 		{
 			if(!_queues.at(i)) continue;
-			if(_queues.at(i)->parameterName == parameterName && _queues.at(i)->channel == channel)
+			if(_queues.at(i)->channel == channel && _queues.at(i)->parameterName == parameterName)
 			{
 				_queuesMutex.unlock();
 				return true;
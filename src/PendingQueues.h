@@ -56,7 +56,7 @@ public:
 	std::shared_ptr<PacketQueue> front();
 	void clear();
 	void remove(std::string value, int32_t channel);
-	bool exists(std::string value, int32_t channel);
+	bool exists(const std::string& value, int32_t channel);
 	bool find(PacketQueueType queueType);
 
 	void getInfoString(std::ostringstream& stringStream);
@@ -34,7 +34,7 @@
 namespace MAX
 {
 
-COC::COC(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IMaxInterface(settings)
+COC::COC(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IMaxInterface(settings), _commandBuffer(std::bind(&COC::writeBuffer, this, std::placeholders::_1))
 {
 	_out.init(GD::bl);
 	_out.setPrefix(GD::out.getPrefix() + "COC \"" + settings->id + "\": ");
@@ -50,6 +50,7 @@ COC::~COC()
 {
 	try
 	{
+		stopTx();
 		if(_socket)
 		{
 			_socket->removeEventHandler(_eventHandlerSelf);
@@ -63,24 +64,16 @@ COC::~COC()
     }
 }
 
-void COC::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
+void COC::transmit(std::shared_ptr<MAXPacket> maxPacket)
 {
 	try
 	{
-		if(!packet)
-		{
-			_out.printWarning("Warning: Packet was nullptr.");
-			return;
-		}
 		if(!_socket)
 		{
 			_out.printError("Error: Couldn't write to COC device, because the device descriptor is not valid: " + _settings->device);
 			return;
 		}
 
-        std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
-        if(!maxPacket) return;
-
 		if(maxPacket->payload().size() > 54)
 		{
 			if(_bl->debugLevel >= 2) _out.printError("Error: Tried to send packet larger than 64 bytes. That is not supported.");
@@ -89,8 +82,10 @@ void COC::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 
 		std::string packetHex = maxPacket->hexString();
 		if(_bl->debugLevel > 3) _out.printInfo("Info: Sending (" + _settings->id + ", WOR: " + (maxPacket->getBurst() ? "yes" : "no") + "): " + packetHex);
-		if(maxPacket->getBurst()) writeToDevice(stackPrefix + "Zs" + packetHex + "\n" + stackPrefix + "Zr\n");
-		else writeToDevice(stackPrefix + "Zf" + packetHex + "\n" + stackPrefix + "Zr\n");
+		_commandBuffer.append(stackPrefix, maxPacket->getBurst() ? "Zs" : "Zf", packetHex);
+		_commandBuffer.append(stackPrefix, "Zr");
+		writeToDevice();
+		if(maxPacket->getBurst()) startBurst(1100);
 	}
 	catch(const std::exception& ex)
     {
@@ -98,25 +93,43 @@ void COC::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
     }
 }
 
-void COC::writeToDevice(std::string data)
+void COC::writeToDevice()
+{
+    try
+    {
+        _commandBuffer.flush();
+    }
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    _lastPacketSent = BaseLib::HelperFunctions::getTime();
+}
+
+int32_t COC::writeBuffer(const std::string& data)
 {
     try
     {
     	if(!_socket)
     	{
     		_out.printError("Error: Couldn't write to COC device, because the device descriptor is not valid: " + _settings->device);
-    		return;
+    		return -1;
     	}
         _socket->writeLine(data);
-
-        bool wor = data.at(1) == 's';
-        if(wor) std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        return 1;
     }
     catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    _lastPacketSent = BaseLib::HelperFunctions::getTime();
+    return -1;
+}
+
+bool COC::getWriteStatistics(uint64_t& frames, uint64_t& systemCalls)
+{
+	frames = _commandBuffer.frames();
+	systemCalls = _commandBuffer.systemCalls();
+	return true;
 }
 
 void COC::startListening()
@@ -142,12 +155,18 @@ void COC::startListening()
 				setGPIO(1, false);
 				std::this_thread::sleep_for(std::chrono::milliseconds(1000));
 				setGPIO(1, true);
-				std::this_thread::sleep_for(std::chrono::milliseconds(2000));
 			}
 			closeGPIO(1);
 		}
-		writeToDevice(stackPrefix + "X21\n" + stackPrefix + "Zr\n");
-		std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+		//Continues as soon as the COC answers. "X21" is sent by lineReceived() then.
+		startHandshake();
+		if(!waitForHandshake(5000, [this]() { _commandBuffer.append(stackPrefix, "V"); writeToDevice(); }))
+		{
+			_out.printWarning("Warning: COC didn't answer the version query. Initializing it anyway.");
+			_commandBuffer.append(stackPrefix, "X21");
+			_commandBuffer.append(stackPrefix, "Zr");
+			writeToDevice();
+		}
 		IPhysicalInterface::startListening();
 	}
     catch(const std::exception& ex)
@@ -160,6 +179,7 @@ void COC::stopListening()
 {
 	try
 	{
+		stopTx();
 		if(!_socket) return;
 		_socket->removeEventHandler(_eventHandlerSelf);
 		_socket->closeDevice();
@@ -188,6 +208,17 @@ void COC::lineReceived(const std::string& data)
 			if(data.substr(0, stackPrefix.size()) != stackPrefix || data.at(stackPrefix.size()) == '*') return;
 			else packetHex = data.substr(stackPrefix.size());
 		}
+		bool handshakeCompleted = false;
+		if(handshakeReply(packetHex, handshakeCompleted))
+		{
+			if(!handshakeCompleted) return;
+			BaseLib::HelperFunctions::trim(packetHex);
+			_out.printInfo("Info: COC is ready: " + packetHex);
+			_commandBuffer.append(stackPrefix, "X21");
+			_commandBuffer.append(stackPrefix, "Zr");
+			writeToDevice();
+			return;
+		}
 		if(packetHex.size() > 21) //21 is minimal packet length (=10 Byte + COC "Z" + "\n")
 		{
 			std::shared_ptr<MAXPacket> packet(new MAXPacket(packetHex, BaseLib::HelperFunctions::getTime()));
@@ -33,6 +33,7 @@
 #include <homegear-base/BaseLib.h>
 
 #include "IMaxInterface.h"
+#include "CommandBuffer.h"
 
 namespace MAX
 {
@@ -44,9 +45,9 @@ class COC : public IMaxInterface, public BaseLib::SerialReaderWriter::ISerialRea
         virtual ~COC();
         void startListening();
         void stopListening();
-        void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
         virtual void setup(int32_t userID, int32_t groupID, bool setPermissions);
         bool isOpen() { return _socket && _socket->isOpen(); }
+        virtual bool getWriteStatistics(uint64_t& frames, uint64_t& systemCalls);
     protected:
         // {{{ Event handling
         BaseLib::PEventHandler _eventHandlerSelf;
@@ -56,8 +57,13 @@ class COC : public IMaxInterface, public BaseLib::SerialReaderWriter::ISerialRea
         BaseLib::Output _out;
         std::shared_ptr<BaseLib::SerialReaderWriter> _socket;
         std::string stackPrefix;
+        CommandBuffer _commandBuffer;
 
-        void writeToDevice(std::string data);
+        void transmit(std::shared_ptr<MAXPacket> packet);
+        //Writes the commands in _commandBuffer
+        void writeToDevice();
+        //Writer of _commandBuffer
+        int32_t writeBuffer(const std::string& data);
     private:
 };
 
@@ -34,7 +34,7 @@
 namespace MAX
 {
 
-CUL::CUL(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IMaxInterface(settings)
+CUL::CUL(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IMaxInterface(settings), _lineReader(200), _commandBuffer(std::bind(&CUL::writeBuffer, this, std::placeholders::_1))
 {
 	_out.init(GD::bl);
 	_out.setPrefix(GD::out.getPrefix() + "CUL \"" + settings->id + "\": ");
@@ -46,6 +46,7 @@ CUL::CUL(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings)
 	}
 
 	memset(&_termios, 0, sizeof(termios));
+	_reactor = GD::reactor;
 }
 
 CUL::~CUL()
@@ -54,6 +55,8 @@ CUL::~CUL()
 	{
 		_stopCallbackThread = true;
 		_bl->threadManager.join(_listenThread);
+		unregisterDevice();
+		stopTx();
 		closeDevice();
 	}
     catch(const std::exception& ex)
@@ -62,29 +65,26 @@ CUL::~CUL()
     }
 }
 
-void CUL::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
+void CUL::transmit(std::shared_ptr<MAXPacket> maxPacket)
 {
 	try
 	{
-		if(!packet)
-		{
-			_out.printWarning("Warning: Packet was nullptr.");
-			return;
-		}
-
 		if(_fileDescriptor->descriptor == -1) throw(BaseLib::Exception("Couldn't write to CUL device, because the file descriptor is not valid: " + _settings->device));
 
-        std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
-        if(!maxPacket) return;
-
 		if(maxPacket->payload().size() > 54)
 		{
 			if(_bl->debugLevel >= 2) _out.printError("Error: Tried to send packet larger than 64 bytes. That is not supported.");
 			return;
 		}
 
-		if(maxPacket->getBurst()) writeToDevice("Zs" + maxPacket->hexString() + "\n", true);
-		else writeToDevice("Zf" + maxPacket->hexString() + "\n", true);
+		if(_stopped) return;
+		std::string packetHex = maxPacket->hexString();
+		if(_bl->debugLevel > 3) _out.printInfo("Info: Sending (" + _settings->id + ", WOR: " + (maxPacket->getBurst() ? "yes" : "no") + "): " + packetHex);
+		_commandBuffer.append(std::string_view(), maxPacket->getBurst() ? "Zs" : "Zf", packetHex);
+		_commandBuffer.flush();
+		_lastPacketSent = BaseLib::HelperFunctions::getTime();
+		//culfw doesn't process commands while sending the burst
+		if(maxPacket->getBurst()) startBurst(1100);
 	}
 	catch(const std::exception& ex)
     {
@@ -97,6 +97,8 @@ void CUL::openDevice()
 	try
 	{
 		if(_fileDescriptor->descriptor > -1) closeDevice();
+		_lineReader.clear();
+		_commandBuffer.clear(); //Commands for the old descriptor
 
 		_lockfile = GD::bl->settings.lockFilePath() + "LCK.." + _settings->device.substr(_settings->device.find_last_of('/') + 1);
 		int lockfileDescriptor = open(_lockfile.c_str(), O_WRONLY | O_EXCL | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH);
@@ -174,8 +176,6 @@ void CUL::setupDevice()
 		if(tcflush(_fileDescriptor->descriptor, TCIFLUSH) == -1) throw(BaseLib::Exception("Couldn't flush CUL device " + _settings->device));
 		if(tcsetattr(_fileDescriptor->descriptor, TCSANOW, &_termios) == -1) throw(BaseLib::Exception("Couldn't set CUL device settings: " + _settings->device));
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-
 		int flags = fcntl(_fileDescriptor->descriptor, F_GETFL);
 		if(!(flags & O_NONBLOCK))
 		{
@@ -191,29 +191,36 @@ void CUL::setupDevice()
     }
 }
 
-std::string CUL::readFromDevice()
+bool CUL::readFromDevice(std::string_view& line)
 {
 	try
 	{
-		if(_stopped) return "";
+		if(_stopped) return false;
 		if(_fileDescriptor->descriptor == -1)
 		{
 			_out.printCritical("Couldn't read from CUL device, because the file descriptor is not valid: " + _settings->device + ". Trying to reopen...");
 			closeDevice();
-			std::this_thread::sleep_for(std::chrono::milliseconds(5000));
+			if(!interruptibleSleep(nextReconnectDelay())) return false;
 			openDevice();
-			if(!isOpen()) return "";
-			writeToDevice("X21\nZr\n", false);
+			if(!isOpen()) return false;
+			//"X21" is sent by processLine() when the CUL answers
+			startHandshake();
+			writeToDevice("V\n");
 		}
-		std::string packet;
 		int32_t i;
-		char localBuffer[1] = "";
 		fd_set readFileDescriptor;
-		FD_ZERO(&readFileDescriptor);
-		FD_SET(_fileDescriptor->descriptor, &readFileDescriptor);
 
-		while((!_stopCallbackThread && localBuffer[0] != '\n' && _fileDescriptor->descriptor > -1))
+		while(!_stopCallbackThread && _fileDescriptor->descriptor > -1)
 		{
+			//Lines received with an earlier read are handed out first.
+			if(_lineReader.nextLine(line)) return true;
+			if(_lineReader.overflow())
+			{
+				_out.printError("CUL was disconnected.");
+				closeDevice();
+				return false;
+			}
+
 			FD_ZERO(&readFileDescriptor);
 			FD_SET(_fileDescriptor->descriptor, &readFileDescriptor);
 			//Timeout needs to be set every time, so don't put it outside of the while loop
@@ -224,34 +231,38 @@ std::string CUL::readFromDevice()
 			switch(i)
 			{
 				case 0: //Timeout
-					if(!_stopCallbackThread) continue;
-					else return "";
+					if(_stopCallbackThread) return false;
+					if(!continueHandshake())
+					{
+						closeDevice();
+						return false;
+					}
+					continue;
 				case -1:
 					_out.printError("Error reading from CUL device: " + _settings->device);
-					return "";
+					return false;
 				case 1:
 					break;
 				default:
 					_out.printError("Error reading from CUL device: " + _settings->device);
-					return "";
+					return false;
 			}
 
-			i = read(_fileDescriptor->descriptor, localBuffer, 1);
-			if(i == -1)
+			//Reads everything the device has buffered instead of one byte per system call
+			ssize_t bytesRead = _lineReader.read(_fileDescriptor->descriptor);
+			if(bytesRead == -1)
 			{
 				if(errno == EAGAIN) continue;
 				_out.printError("Error reading from CUL device: " + _settings->device);
-				return "";
+				return false;
 			}
-			packet.push_back(localBuffer[0]);
-			if(packet.size() > 200)
+			else if(bytesRead == 0) //End of file => device was unplugged
 			{
 				_out.printError("CUL was disconnected.");
 				closeDevice();
-				return "";
+				return false;
 			}
 		}
-		return packet;
 	}
 	catch(const std::exception& ex)
     {
@@ -261,23 +272,37 @@ std::string CUL::readFromDevice()
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
     }
-	return "";
+	return false;
 }
 
-void CUL::writeToDevice(std::string data, bool printSending)
+void CUL::writeToDevice(std::string_view data)
 {
     try
     {
     	if(_stopped) return;
         if(_fileDescriptor->descriptor == -1) throw(BaseLib::Exception("Couldn't write to CUL device, because the file descriptor is not valid: " + _settings->device));
-        int32_t bytesWritten = 0;
-        int32_t i;
-        bool wor = data.at(1) == 's';
-        if(_bl->debugLevel > 3 && printSending) _out.printInfo("Info: Sending (" + _settings->id + ", WOR: " + (wor ? "yes" : "no") + "): " + data.substr(2, data.size() - 3));
-        _sendMutex.lock();
-        while(bytesWritten < (signed)data.length())
+        _commandBuffer.append(data);
+        _commandBuffer.flush();
+    }
+    catch(const std::exception& ex)
+    {
+    	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    _lastPacketSent = BaseLib::HelperFunctions::getTime();
+}
+
+int32_t CUL::writeBuffer(const std::string& data)
+{
+    int32_t systemCalls = 0;
+    try
+    {
+        std::lock_guard<std::mutex> sendGuard(_sendMutex);
+        if(_fileDescriptor->descriptor == -1) throw(BaseLib::Exception("Couldn't write to CUL device, because the file descriptor is not valid: " + _settings->device));
+        size_t bytesWritten = 0;
+        while(bytesWritten < data.size())
         {
-            i = write(_fileDescriptor->descriptor, data.c_str() + bytesWritten, data.length() - bytesWritten);
+            systemCalls++;
+            ssize_t i = write(_fileDescriptor->descriptor, data.data() + bytesWritten, data.size() - bytesWritten);
             if(i == -1)
             {
                 if(errno == EAGAIN) continue;
@@ -285,14 +310,20 @@ void CUL::writeToDevice(std::string data, bool printSending)
             }
             bytesWritten += i;
         }
-        if(wor) std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        return systemCalls;
     }
     catch(const std::exception& ex)
     {
     	_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    _sendMutex.unlock();
-    _lastPacketSent = BaseLib::HelperFunctions::getTime();
+    return -1;
+}
+
+bool CUL::getWriteStatistics(uint64_t& frames, uint64_t& systemCalls)
+{
+	frames = _commandBuffer.frames();
+	systemCalls = _commandBuffer.systemCalls();
+	return true;
 }
 
 void CUL::startListening()
@@ -303,10 +334,21 @@ void CUL::startListening()
 		openDevice();
 		if(_fileDescriptor->descriptor == -1) return;
 		_stopped = false;
-		writeToDevice("X21\nZr\n", false);
-		std::this_thread::sleep_for(std::chrono::milliseconds(400));
-		if(_settings->listenThreadPriority > -1) _bl->threadManager.start(_listenThread, true, _settings->listenThreadPriority, _settings->listenThreadPolicy, &CUL::listen, this);
+		_stopCallbackThread = false;
+		if(_reactor)
+		{
+			std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+			registerDevice();
+		}
+		else if(_settings->listenThreadPriority > -1) _bl->threadManager.start(_listenThread, true, _settings->listenThreadPriority, _settings->listenThreadPolicy, &CUL::listen, this);
 		else _bl->threadManager.start(_listenThread, true, &CUL::listen, this);
+		//Continues as soon as the CUL answers. "X21" is sent by processLine() then.
+		startHandshake();
+		if(!waitForHandshake(5000, [this]() { writeToDevice("V\n"); }))
+		{
+			_out.printWarning("Warning: CUL didn't answer the version query. Reopening...");
+			if(_reactor) reconnect(); //Without reactor the listen thread reopens the device
+		}
 		IPhysicalInterface::startListening();
 	}
     catch(const std::exception& ex)
@@ -321,12 +363,15 @@ void CUL::stopListening()
 	{
 		_stopCallbackThread = true;
 		_bl->threadManager.join(_listenThread);
-		_stopCallbackThread = false;
+		unregisterDevice();
+		stopTx();
+		//_stopCallbackThread stays set until startListening(), so reactor handlers can't reopen the device.
 		if(_fileDescriptor->descriptor > -1)
 		{
 			//Other X commands than 00 seem to slow down data processing
-			writeToDevice("Zx\nX00\n", false);
-			std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+			writeToDevice("Zx\nX00\n");
+			//Closing the device right away would discard the commands
+			tcdrain(_fileDescriptor->descriptor);
 			closeDevice();
 		}
 		_stopped = true;
@@ -350,18 +395,9 @@ void CUL::listen()
         		if(_stopCallbackThread) return;
         		continue;
         	}
-        	std::string packetHex = readFromDevice();
-        	if(packetHex.size() > 21) //21 is minimal packet length (=10 Byte + CUL "Z" + "\n")
-        	{
-				std::shared_ptr<MAXPacket> packet(new MAXPacket(packetHex, BaseLib::HelperFunctions::getTime()));
-				raisePacketReceived(packet);
-        	}
-        	else if(!packetHex.empty())
-        	{
-        		if(packetHex.compare(0, 4, "LOVF") == 0) _out.printWarning("Warning: CUL with id " + _settings->id + " reached 1% limit. You need to wait, before sending is allowed again.");
-        		else if(packetHex == "Z") continue;
-        		else _out.printWarning("Warning: Too short packet received: " + packetHex);
-        	}
+        	std::string_view packetHex;
+        	if(!readFromDevice(packetHex)) continue;
+        	processLine(packetHex);
         }
     }
     catch(const std::exception& ex)
@@ -370,6 +406,214 @@ void CUL::listen()
     }
 }
 
+void CUL::processLine(std::string_view packetHex)
+{
+    try
+    {
+    	bool handshakeCompleted = false;
+    	if(handshakeReply(packetHex, handshakeCompleted))
+    	{
+    		if(!handshakeCompleted) return;
+    		std::string version(packetHex);
+    		BaseLib::HelperFunctions::trim(version);
+    		_out.printInfo("Info: CUL is ready: " + version);
+    		writeToDevice("X21\nZr\n");
+    		resetReconnectDelay();
+    		return;
+    	}
+    	if(packetHex.size() > 21) //21 is minimal packet length (=10 Byte + CUL "Z" + "\n")
+    	{
+			std::shared_ptr<MAXPacket> packet(new MAXPacket(packetHex, BaseLib::HelperFunctions::getTime()));
+			raisePacketReceived(packet);
+    	}
+    	else if(!packetHex.empty())
+    	{
+    		if(packetHex.compare(0, 4, "LOVF") == 0) _out.printWarning("Warning: CUL with id " + _settings->id + " reached 1% limit. You need to wait, before sending is allowed again.");
+    		else if(packetHex == "Z") return;
+    		else _out.printWarning("Warning: Too short packet received: " + std::string(packetHex));
+    	}
+    }
+    catch(const std::exception& ex)
+    {
+        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+}
+
+void CUL::registerDevice()
+{
+	try
+	{
+		int32_t descriptor = _fileDescriptor->descriptor;
+		if(descriptor == -1) return;
+		if(_reactor->add(descriptor, EPOLLIN, std::bind(&CUL::processEvents, this, std::placeholders::_1))) _registeredDescriptor = descriptor;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CUL::unregisterDevice()
+{
+	try
+	{
+		if(!_reactor) return;
+		//_stopCallbackThread needs to be set, so the handlers don't register again. Handlers check it while holding
+		//_reactorMutex, so after this block nothing new is registered.
+		int32_t descriptor = -1;
+		uint64_t timer = 0;
+		{
+			std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+			descriptor = _registeredDescriptor.exchange(-1);
+			timer = _reconnectTimer.exchange(0);
+		}
+		//Not under _reactorMutex, because running handlers might wait for it. removeTimer() always waits for running
+		//handlers, also when there is no timer.
+		if(descriptor != -1) _reactor->remove(descriptor);
+		_reactor->removeTimer(timer);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CUL::processEvents(uint32_t events)
+{
+	try
+	{
+		if(_stopCallbackThread || _stopped) return;
+		//Edge triggered, so everything needs to be read
+		while(true)
+		{
+			ssize_t bytesRead = _lineReader.read(_registeredDescriptor);
+			if(bytesRead > 0)
+			{
+				std::string_view line;
+				while(_lineReader.nextLine(line)) processLine(line);
+				if(_lineReader.overflow())
+				{
+					_out.printError("CUL was disconnected.");
+					reconnect();
+					return;
+				}
+				continue;
+			}
+			else if(bytesRead == -1)
+			{
+				if(errno == EINTR) continue;
+				if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+				_out.printError("Error reading from CUL device: " + _settings->device);
+			}
+			else _out.printError("CUL was disconnected."); //End of file => device was unplugged
+			reconnect();
+			return;
+		}
+		if(events & (EPOLLERR | EPOLLHUP))
+		{
+			_out.printError("CUL was disconnected.");
+			reconnect();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CUL::reconnect()
+{
+	try
+	{
+		std::unique_lock<std::mutex> reactorGuard(_reactorMutex);
+		int32_t descriptor = _registeredDescriptor.exchange(-1);
+		if(descriptor != -1)
+		{
+			//remove() waits for running handlers, which might wait for _reactorMutex
+			reactorGuard.unlock();
+			_reactor->remove(descriptor);
+			reactorGuard.lock();
+		}
+		closeDevice();
+		//Stopped, or a pending reopen() or checkHandshake() timer takes it from here
+		if(_stopCallbackThread || _reconnectTimer != 0) return;
+		int64_t delay = nextReconnectDelay();
+		_out.printInfo("Info: Trying to reopen CUL device in " + std::to_string(delay) + " ms...");
+		_reconnectTimer = _reactor->addTimer(delay, std::bind(&CUL::reopen, this));
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CUL::reopen()
+{
+	try
+	{
+		std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+		_reconnectTimer = 0;
+		if(_stopCallbackThread) return;
+		openDevice();
+		if(!isOpen())
+		{
+			_reconnectTimer = _reactor->addTimer(nextReconnectDelay(), std::bind(&CUL::reopen, this));
+			return;
+		}
+		registerDevice();
+		//Don't block the reactor while the device starts up. checkHandshake() continues until it answers.
+		startHandshake();
+		writeToDevice("V\n");
+		_reconnectTimer = _reactor->addTimer(250, std::bind(&CUL::checkHandshake, this));
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CUL::checkHandshake()
+{
+	try
+	{
+		std::unique_lock<std::mutex> reactorGuard(_reactorMutex);
+		_reconnectTimer = 0;
+		if(_stopCallbackThread) return;
+		if(!continueHandshake())
+		{
+			//reconnect() locks _reactorMutex itself and checks _stopCallbackThread again
+			reactorGuard.unlock();
+			reconnect();
+			return;
+		}
+		if(handshakePending()) _reconnectTimer = _reactor->addTimer(250, std::bind(&CUL::checkHandshake, this));
+		else _out.printInfo("Info: CUL device reopened.");
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool CUL::continueHandshake()
+{
+	try
+	{
+		if(!handshakePending()) return true;
+		if(handshakeExpired(5000))
+		{
+			_out.printError("Error: CUL didn't answer the version query.");
+			return false;
+		}
+		writeToDevice("V\n");
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return true;
+}
+
 void CUL::setup(int32_t userID, int32_t groupID, bool setPermissions)
 {
     try
@@ -33,6 +33,9 @@
 #include <homegear-base/BaseLib.h>
 
 #include "IMaxInterface.h"
+#include "CommandBuffer.h"
+#include "LineReader.h"
+#include "Reactor.h"
 
 #include <thread>
 #include <iostream>
@@ -43,11 +46,13 @@
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <string_view>
 
 #include <unistd.h>
 #include <fcntl.h>
 #include <termios.h>
 #include <signal.h>
+#include <sys/epoll.h>
 
 namespace MAX
 {
@@ -59,18 +64,46 @@ class CUL : public IMaxInterface
         virtual ~CUL();
         void startListening();
         void stopListening();
-        void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
         virtual void setup(int32_t userID, int32_t groupID, bool setPermissions);
+        virtual bool getWriteStatistics(uint64_t& frames, uint64_t& systemCalls);
     protected:
         BaseLib::Output _out;
+        void transmit(std::shared_ptr<MAXPacket> packet);
+        //The device is not usable right after opening it. Use the readiness handshake before sending commands.
         void openDevice();
         void closeDevice();
         void setupDevice();
-        void writeToDevice(std::string, bool);
-        std::string readFromDevice();
+        //Sends the version query again. Returns false when the CUL didn't answer in time and needs to be reopened.
+        bool continueHandshake();
+        //Writes complete lines
+        void writeToDevice(std::string_view data);
+        //Writer of _commandBuffer
+        int32_t writeBuffer(const std::string& data);
+        //Returns true and sets "line" when a complete line was received. The line is valid until the next call.
+        bool readFromDevice(std::string_view& line);
+        void processLine(std::string_view line);
         void listen();
+
+        //{{{ Shared reactor
+        //Needs _reactorMutex
+        void registerDevice();
+        void unregisterDevice();
+        void processEvents(uint32_t events);
+        void reconnect();
+        void reopen();
+        void checkHandshake();
+        //}}}
     private:
         struct termios _termios;
+        LineReader _lineReader;
+        CommandBuffer _commandBuffer;
+        //When set, received data is processed by the shared reactor instead of the listen thread
+        std::shared_ptr<Reactor> _reactor;
+        std::atomic<int32_t> _registeredDescriptor{-1};
+        std::atomic<uint64_t> _reconnectTimer{0};
+        //Held while the descriptor or the reconnect timer is (un)registered. Reactor handlers check _stopCallbackThread
+        //while holding it.
+        std::mutex _reactorMutex;
 };
 
 }
@@ -0,0 +1,322 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "Cc1101Model.h"
+
+namespace MAX
+{
+
+Cc1101Model::Cc1101Model()
+{
+	reset();
+}
+
+void Cc1101Model::reset()
+{
+	std::lock_guard<std::mutex> modelGuard(_mutex);
+	resetRegisters();
+}
+
+void Cc1101Model::resetRegisters()
+{
+	//Reset values from the data sheet
+	_registers =
+	{
+		0x29, 0x2E, 0x3F, 0x07, 0xD3, 0x91, 0xFF, 0x04, 0x45, 0x00, 0x00, 0x0F, 0x00, 0x1E, 0xC4, 0xEC, //00 - 0F
+		0x8C, 0x22, 0x02, 0x22, 0xF8, 0x47, 0x07, 0x30, 0x04, 0x36, 0x6C, 0x03, 0x40, 0x91, 0x87, 0x6B, //10 - 1F
+		0xF8, 0x56, 0x10, 0xA9, 0x0A, 0x20, 0x0D, 0x41, 0x00, 0x59, 0x7F, 0x3F, 0x88, 0x31, 0x0B        //20 - 2E
+	};
+	_patable = { 0xC6, 0, 0, 0, 0, 0, 0, 0 };
+	_patableIndex = 0;
+	_state = State::IDLE;
+	_rxFifo.clear();
+	_txFifo.clear();
+	_rssi = 0;
+	_lqi = 0;
+	_edges.clear();
+	uint8_t config = _registers[_interruptPin == 2 ? 0x00 : 0x02];
+	_gdoLevel = (config & 0x40);
+}
+
+void Cc1101Model::setInterruptPin(uint32_t gdo)
+{
+	std::lock_guard<std::mutex> modelGuard(_mutex);
+	_interruptPin = gdo;
+}
+
+void Cc1101Model::setTransmitHandler(TransmitHandler handler)
+{
+	std::lock_guard<std::mutex> modelGuard(_mutex);
+	_transmitHandler = handler;
+}
+
+uint8_t Cc1101Model::state()
+{
+	std::lock_guard<std::mutex> modelGuard(_mutex);
+	return _state;
+}
+
+uint8_t Cc1101Model::statusByte(bool read)
+{
+	//CHIP_RDYn is always 0, as the crystal is always running
+	uint32_t fifoBytes = read ? _rxFifo.size() : _fifoSize - _txFifo.size();
+	return (uint8_t)_state | (uint8_t)(fifoBytes > 15 ? 15 : fifoBytes);
+}
+
+uint8_t Cc1101Model::readStatusRegister(uint8_t address)
+{
+	switch(address)
+	{
+		case 0x30: return 0x00; //PARTNUM
+		case 0x31: return 0x14; //VERSION
+		case 0x33: return _lqi;
+		case 0x34: return _rssi;
+		case 0x35: //MARCSTATE
+			switch(_state)
+			{
+				case State::IDLE: return 0x01;
+				case State::RX: return 0x0D;
+				case State::TX: return 0x13;
+				case State::FSTXON: return 0x12;
+				case State::RXFIFO_OVERFLOW: return 0x11;
+				case State::TXFIFO_UNDERFLOW: return 0x16;
+			}
+			return 0x01;
+		case 0x38: //PKTSTATUS
+			return (uint8_t)(_gdoLevel ? (_interruptPin == 2 ? 0x04 : 0x01) : 0);
+		case 0x3A: return (uint8_t)_txFifo.size() | (_state == State::TXFIFO_UNDERFLOW ? 0x80 : 0); //TXBYTES
+		case 0x3B: return (uint8_t)_rxFifo.size() | (_state == State::RXFIFO_OVERFLOW ? 0x80 : 0); //RXBYTES
+		case 0x3C: return _registers[0x27]; //RCCTRL1_STATUS
+		case 0x3D: return _registers[0x28]; //RCCTRL0_STATUS
+		default: return 0;
+	}
+}
+
+void Cc1101Model::setGdo(bool asserted)
+{
+	uint8_t config = _registers[_interruptPin == 2 ? 0x00 : 0x02];
+	if((config & 0x3F) != 0x06) return; //Only "sync word sent or received" is modeled
+	bool level = asserted != (bool)(config & 0x40);
+	if(level == _gdoLevel) return;
+	_gdoLevel = level;
+	if(_edges.size() >= 64) _edges.pop_front();
+	_edges.push_back(level);
+	_edgeConditionVariable.notify_all();
+}
+
+void Cc1101Model::enterOffMode(bool afterRx)
+{
+	uint8_t mode = afterRx ? ((_registers[0x17] >> 2) & 3) : (_registers[0x17] & 3);
+	switch(mode)
+	{
+		case 0: _state = State::IDLE; break;
+		case 1: _state = State::FSTXON; break;
+		case 2: _state = State::TX; transmitFifo(); break;
+		case 3: _state = State::RX; break;
+	}
+}
+
+void Cc1101Model::transmitFifo()
+{
+	//Without data the chip sends preamble until the FIFO is written
+	if(_state != State::TX || _txFifo.empty()) return;
+	uint32_t length = _txFifo.front();
+	if(_txFifo.size() < length + 1) return;
+	std::vector<uint8_t> packet(_txFifo.begin(), _txFifo.begin() + length + 1);
+	_txFifo.erase(_txFifo.begin(), _txFifo.begin() + length + 1);
+	setGdo(true);
+	setGdo(false);
+	_transmittedPackets.push_back(std::move(packet));
+	enterOffMode(false);
+}
+
+void Cc1101Model::strobe(uint8_t command)
+{
+	switch(command)
+	{
+		case 0x30: //SRES
+			resetRegisters();
+			break;
+		case 0x31: //SFSTXON
+			if(_state == State::IDLE) _state = State::FSTXON;
+			break;
+		case 0x34: //SRX
+			if(_state == State::RXFIFO_OVERFLOW || _state == State::TXFIFO_UNDERFLOW) break;
+			if(_state == State::TX) setGdo(false);
+			_state = State::RX;
+			break;
+		case 0x35: //STX
+			if(_state == State::RXFIFO_OVERFLOW || _state == State::TXFIFO_UNDERFLOW) break;
+			_state = State::TX;
+			transmitFifo();
+			break;
+		case 0x36: //SIDLE
+			if(_state == State::RXFIFO_OVERFLOW || _state == State::TXFIFO_UNDERFLOW) break;
+			setGdo(false);
+			_state = State::IDLE;
+			break;
+		case 0x3A: //SFRX, only accepted in IDLE and RXFIFO_OVERFLOW
+			if(_state != State::IDLE && _state != State::RXFIFO_OVERFLOW) break;
+			_rxFifo.clear();
+			_state = State::IDLE;
+			break;
+		case 0x3B: //SFTX, only accepted in IDLE and TXFIFO_UNDERFLOW
+			if(_state != State::IDLE && _state != State::TXFIFO_UNDERFLOW) break;
+			_txFifo.clear();
+			_state = State::IDLE;
+			break;
+		default: //SXOFF, SCAL, SWOR, SPWD, SWORRST and SNOP don't change the modeled state
+			break;
+	}
+}
+
+void Cc1101Model::transfer(uint8_t* data, uint32_t size)
+{
+	std::vector<std::vector<uint8_t>> transmittedPackets;
+	TransmitHandler transmitHandler;
+	{
+		std::lock_guard<std::mutex> modelGuard(_mutex);
+		_accessCount++;
+		if(!data || size == 0) return;
+		uint8_t header = data[0];
+		bool read = header & 0x80;
+		bool burst = header & 0x40;
+		uint8_t address = header & 0x3F;
+		data[0] = statusByte(read);
+
+		if(address >= 0x30 && address <= 0x3D)
+		{
+			//Without burst bit these addresses are command strobes, with burst bit status registers
+			if(!burst) strobe(address);
+			else for(uint32_t i = 1; i < size; i++) data[i] = read ? readStatusRegister(address) : statusByte(false);
+		}
+		else if(address == 0x3E) //PATABLE
+		{
+			for(uint32_t i = 1; i < size && (burst || i == 1); i++)
+			{
+				if(read) data[i] = _patable[_patableIndex];
+				else
+				{
+					_patable[_patableIndex] = data[i];
+					data[i] = statusByte(false);
+				}
+				_patableIndex = (_patableIndex + 1) % _patable.size();
+			}
+			_patableIndex = 0; //Reset when chip select goes high
+		}
+		else if(address == 0x3F) //FIFO
+		{
+			for(uint32_t i = 1; i < size && (burst || i == 1); i++)
+			{
+				if(read)
+				{
+					if(_rxFifo.empty()) data[i] = 0;
+					else
+					{
+						data[i] = _rxFifo.front();
+						_rxFifo.pop_front();
+					}
+				}
+				else
+				{
+					if(_txFifo.size() < _fifoSize) _txFifo.push_back(data[i]);
+					data[i] = statusByte(false);
+				}
+			}
+			if(!read) transmitFifo();
+		}
+		else
+		{
+			for(uint32_t i = 1; i < size && (burst || i == 1); i++)
+			{
+				uint32_t registerAddress = address + i - 1;
+				if(registerAddress >= _registers.size()) break;
+				if(read) data[i] = _registers[registerAddress];
+				else
+				{
+					_registers[registerAddress] = data[i];
+					data[i] = statusByte(false);
+					if(registerAddress == (_interruptPin == 2 ? 0x00u : 0x02u)) _gdoLevel = (_registers[registerAddress] & 0x40);
+				}
+			}
+		}
+
+		if(_transmittedPackets.empty()) return;
+		transmittedPackets.swap(_transmittedPackets);
+		transmitHandler = _transmitHandler;
+	}
+	if(!transmitHandler) return;
+	for(auto& packet : transmittedPackets) transmitHandler(packet);
+}
+
+bool Cc1101Model::receive(const std::vector<uint8_t>& packet, uint8_t rssi, uint8_t lqi, bool crcOK)
+{
+	std::lock_guard<std::mutex> modelGuard(_mutex);
+	if(_state != State::RX || packet.empty()) return false;
+	setGdo(true);
+	_rssi = rssi;
+	_lqi = (lqi & 0x7F) | (crcOK ? 0x80 : 0);
+	bool appendStatus = _registers[0x07] & 0x04;
+	bool autoflush = _registers[0x07] & 0x08;
+	if(crcOK || !autoflush)
+	{
+		std::vector<uint8_t> data(packet);
+		if(appendStatus)
+		{
+			data.push_back(_rssi);
+			data.push_back(_lqi);
+		}
+		for(uint8_t byte : data)
+		{
+			if(_rxFifo.size() >= _fifoSize)
+			{
+				//GDO is deasserted on overflow, too
+				_state = State::RXFIFO_OVERFLOW;
+				_rxOverflows++;
+				setGdo(false);
+				return true;
+			}
+			_rxFifo.push_back(byte);
+		}
+	}
+	setGdo(false);
+	enterOffMode(true);
+	return true;
+}
+
+int32_t Cc1101Model::waitForEdge(int32_t timeout, bool& high)
+{
+	std::unique_lock<std::mutex> modelGuard(_mutex);
+	if(!_edgeConditionVariable.wait_for(modelGuard, std::chrono::milliseconds(timeout), [&] { return !_edges.empty(); })) return 0;
+	high = _edges.front();
+	_edges.pop_front();
+	return 1;
+}
+
+}
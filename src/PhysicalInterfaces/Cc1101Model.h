@@ -0,0 +1,120 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef HOMEGEAR_MAX_CC1101MODEL_H
+#define HOMEGEAR_MAX_CC1101MODEL_H
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace MAX
+{
+
+//Software model of a TI CC1101 as seen over SPI: configuration and status registers, command strobes, the main radio
+//states, RX and TX FIFO including overflow and underflow, the status byte and the GDO pin used as interrupt. Packets
+//are exchanged with receive() and the transmit handler instead of a radio. Timing on air is not modeled.
+class Cc1101Model
+{
+public:
+	typedef std::function<void(const std::vector<uint8_t>& packet)> TransmitHandler;
+
+	Cc1101Model();
+	virtual ~Cc1101Model() {}
+
+	//Power on reset
+	void reset();
+	//One access while chip select is low. "data" is shifted out and replaced by the received bytes like on the bus.
+	void transfer(uint8_t* data, uint32_t size);
+
+	//Simulates a packet on air. "packet" starts with the length byte. Returns false when the chip is not receiving.
+	bool receive(const std::vector<uint8_t>& packet, uint8_t rssi = 0x40, uint8_t lqi = 0x20, bool crcOK = true);
+	//Called with the length byte and payload of every transmitted packet
+	void setTransmitHandler(TransmitHandler handler);
+	//Waits up to "timeout" milliseconds for a level change of the interrupt pin. Returns 1 and sets "high" on an edge and
+	//0 on timeout.
+	int32_t waitForEdge(int32_t timeout, bool& high);
+	//0 for GDO0, 2 for GDO2
+	void setInterruptPin(uint32_t gdo);
+
+	uint8_t state();
+	uint64_t accessCount() { return _accessCount; }
+	uint64_t rxOverflows() { return _rxOverflows; }
+protected:
+	struct State
+	{
+		enum Enum
+		{
+			IDLE = 0x00,
+			RX = 0x10,
+			TX = 0x20,
+			FSTXON = 0x30,
+			RXFIFO_OVERFLOW = 0x60,
+			TXFIFO_UNDERFLOW = 0x70
+		};
+	};
+
+	static const uint32_t _fifoSize = 64;
+
+	std::mutex _mutex;
+	std::condition_variable _edgeConditionVariable;
+	std::array<uint8_t, 0x2F> _registers;
+	std::array<uint8_t, 8> _patable;
+	uint32_t _patableIndex = 0;
+	State::Enum _state = State::IDLE;
+	std::deque<uint8_t> _rxFifo;
+	std::deque<uint8_t> _txFifo;
+	uint8_t _rssi = 0;
+	uint8_t _lqi = 0;
+	uint32_t _interruptPin = 0;
+	bool _gdoLevel = false;
+	std::deque<bool> _edges;
+	TransmitHandler _transmitHandler;
+	std::vector<std::vector<uint8_t>> _transmittedPackets;
+	uint64_t _accessCount = 0;
+	uint64_t _rxOverflows = 0;
+
+	void resetRegisters();
+	uint8_t statusByte(bool read);
+	uint8_t readStatusRegister(uint8_t address);
+	void strobe(uint8_t command);
+	//"asserted" is the state of the "sync word sent or received" signal. The pin level depends on the inversion bit.
+	void setGdo(bool asserted);
+	//Sends the packet in the TX FIFO when it is complete
+	void transmitFifo();
+	void enterOffMode(bool afterRx);
+};
+
+}
+
+#endif
@@ -0,0 +1,236 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "CocGroup.h"
+#include "../MAXPacket.h"
+#include "../GD.h"
+
+namespace MAX
+{
+
+CocGroup::CocGroup(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings, std::vector<std::shared_ptr<COC>> members) : IMaxInterface(settings), _members(std::move(members))
+{
+	try
+	{
+		_out.init(GD::bl);
+		_out.setPrefix(GD::out.getPrefix() + "COC group \"" + settings->id + "\": ");
+
+		for(auto& member : _members)
+		{
+			_memberEventHandlers.push_back(member->addEventHandler((BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink*)this));
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+CocGroup::~CocGroup()
+{
+	try
+	{
+		for(uint32_t i = 0; i < _members.size() && i < _memberEventHandlers.size(); i++)
+		{
+			_members[i]->removeEventHandler(_memberEventHandlers[i]);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CocGroup::startListening()
+{
+	try
+	{
+		for(auto& member : _members) member->startListening();
+		IPhysicalInterface::startListening();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CocGroup::stopListening()
+{
+	try
+	{
+		for(auto& member : _members) member->stopListening();
+		IPhysicalInterface::stopListening();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void CocGroup::setup(int32_t userID, int32_t groupID, bool setPermissions)
+{
+	try
+	{
+		for(auto& member : _members) member->setup(userID, groupID, setPermissions);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool CocGroup::isOpen()
+{
+	for(auto& member : _members)
+	{
+		if(member->isOpen()) return true;
+	}
+	return false;
+}
+
+bool CocGroup::getWriteStatistics(uint64_t& frames, uint64_t& systemCalls)
+{
+	frames = 0;
+	systemCalls = 0;
+	for(auto& member : _members)
+	{
+		uint64_t memberFrames = 0;
+		uint64_t memberSystemCalls = 0;
+		if(!member->getWriteStatistics(memberFrames, memberSystemCalls)) continue;
+		frames += memberFrames;
+		systemCalls += memberSystemCalls;
+	}
+	return true;
+}
+
+uint32_t CocGroup::selectMember(int32_t destinationAddress)
+{
+	std::lock_guard<std::mutex> scheduleGuard(_scheduleMutex);
+	int64_t time = BaseLib::HelperFunctions::getTime();
+	//Like the recent packets, entries are only needed for a while. Entries of members with work queued are kept.
+	if(time - _lastPrune > _echoWindow)
+	{
+		_lastPrune = time;
+		for(auto entryIterator = _memberByDestination.begin(); entryIterator != _memberByDestination.end();)
+		{
+			if(time - entryIterator->second.second > _echoWindow && _members[entryIterator->second.first]->txIdle()) entryIterator = _memberByDestination.erase(entryIterator);
+			else ++entryIterator;
+		}
+	}
+
+	//Packets to one peer must not overtake each other, so they stay on the member as long as it has work queued.
+	auto memberIterator = _memberByDestination.find(destinationAddress);
+	if(memberIterator != _memberByDestination.end() && !_members[memberIterator->second.first]->txIdle())
+	{
+		memberIterator->second.second = time;
+		return memberIterator->second.first;
+	}
+
+	//Otherwise the next idle member. Starting behind the member used last spreads the load. When all are busy, the next
+	//open one queues the packet. A closed member is only used when all are closed.
+	uint32_t member = _nextMember % _members.size();
+	bool idle = false;
+	bool open = false;
+	for(uint32_t i = 0; i < _members.size() && !idle; i++)
+	{
+		uint32_t index = (_nextMember + i) % _members.size();
+		if(!_members[index]->isOpen()) continue;
+		if(_members[index]->txIdle()) idle = true;
+		else if(open) continue;
+		member = index;
+		open = true;
+	}
+	_nextMember = member + 1;
+	_memberByDestination[destinationAddress] = std::make_pair(member, time);
+	return member;
+}
+
+void CocGroup::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
+{
+	try
+	{
+		std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
+		if(!maxPacket || _members.empty()) return;
+		seen(maxPacket->hexString(), true);
+		uint32_t member = selectMember(maxPacket->destinationAddress());
+		if(_bl->debugLevel >= 5) _out.printDebug("Debug: Sending packet to 0x" + BaseLib::HelperFunctions::getHexString(maxPacket->destinationAddress(), 6) + " on stack position " + std::to_string(member + 1) + " of the group.");
+		_members[member]->sendPacket(maxPacket);
+		_lastPacketSent = BaseLib::HelperFunctions::getTime();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool CocGroup::seen(const std::string& hex, bool sent)
+{
+	std::lock_guard<std::mutex> recentPacketsGuard(_recentPacketsMutex);
+	int64_t time = BaseLib::HelperFunctions::getTime();
+	while(!_recentPackets.empty() && time - _recentPackets.front().time > _echoWindow) _recentPackets.pop_front();
+	//Sent packets are always remembered, as resent packets are identical
+	if(!sent)
+	{
+		for(auto& recentPacket : _recentPackets)
+		{
+			if(recentPacket.hex != hex) continue;
+			if(recentPacket.sent || time - recentPacket.time <= _duplicateWindow) return true;
+		}
+	}
+	RecentPacket recentPacket;
+	recentPacket.time = time;
+	recentPacket.sent = sent;
+	recentPacket.hex = hex;
+	_recentPackets.push_back(std::move(recentPacket));
+	return false;
+}
+
+bool CocGroup::onPacketReceived(std::string& senderID, std::shared_ptr<BaseLib::Systems::Packet> packet)
+{
+	try
+	{
+		std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
+		if(!maxPacket) return false;
+		//Every member calls this from its own listen thread. The central hands the packets of an interface to an SPSC queue,
+		//which needs a single producer, so the group raises one packet at a time.
+		std::lock_guard<std::mutex> raiseGuard(_raiseMutex);
+		//Packets of the group received by another module and packets received by more than one module
+		if(seen(maxPacket->hexString(), false)) return true;
+		_lastPacketReceived = BaseLib::HelperFunctions::getTime();
+		raisePacketReceived(packet);
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+}
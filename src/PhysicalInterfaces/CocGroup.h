@@ -0,0 +1,99 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef HOMEGEAR_MAX_COCGROUP_H
+#define HOMEGEAR_MAX_COCGROUP_H
+
+#include <homegear-base/BaseLib.h>
+
+#include "IMaxInterface.h"
+#include "COC.h"
+
+#include <deque>
+#include <unordered_map>
+
+namespace MAX
+{
+
+//Stacked COC modules on one serial device used as one interface. Every packet is sent by a module which is not busy
+//with a wake-on-radio burst, so bursts to different peers run in parallel. Received packets are raised with the id of
+//the group. Packets received by more than one module and packets sent by the group itself are only raised once or not
+//at all.
+class CocGroup : public IMaxInterface, public BaseLib::Systems::IPhysicalInterface::IPhysicalInterfaceEventSink
+{
+public:
+	//"members" need to be sorted by stack position
+	CocGroup(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings, std::vector<std::shared_ptr<COC>> members);
+	virtual ~CocGroup();
+
+	void startListening();
+	void stopListening();
+	virtual void setup(int32_t userID, int32_t groupID, bool setPermissions);
+	virtual bool isOpen();
+	virtual void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
+	virtual bool getWriteStatistics(uint64_t& frames, uint64_t& systemCalls);
+
+	//Called by the members
+	virtual bool onPacketReceived(std::string& senderID, std::shared_ptr<BaseLib::Systems::Packet> packet);
+protected:
+	//Time in milliseconds in which a packet received by another module is a duplicate
+	static const int64_t _duplicateWindow = 500;
+	//Time in milliseconds in which a packet received by a module is one sent by the group. Covers a burst.
+	static const int64_t _echoWindow = 3000;
+
+	BaseLib::Output _out;
+	std::vector<std::shared_ptr<COC>> _members;
+	std::vector<BaseLib::PEventHandler> _memberEventHandlers;
+
+	std::mutex _scheduleMutex;
+	//Destination address => index of the member which sent the last packet to it and the time
+	std::unordered_map<int32_t, std::pair<uint32_t, int64_t>> _memberByDestination;
+	uint32_t _nextMember = 0;
+	int64_t _lastPrune = 0;
+
+	class RecentPacket
+	{
+	public:
+		int64_t time = 0;
+		bool sent = false;
+		std::string hex;
+	};
+	//Serializes raisePacketReceived() of the members' listen threads
+	std::mutex _raiseMutex;
+	std::mutex _recentPacketsMutex;
+	std::deque<RecentPacket> _recentPackets;
+
+	uint32_t selectMember(int32_t destinationAddress);
+	//Returns true when the packet was seen before. Remembers it otherwise.
+	bool seen(const std::string& hex, bool sent);
+};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "CommandBuffer.h"
+
+#include <algorithm>
+
+namespace MAX
+{
+
+CommandBuffer::CommandBuffer(Writer writer) : _writer(std::move(writer))
+{
+	_buffer.reserve(256);
+	_writeBuffer.reserve(256);
+}
+
+void CommandBuffer::append(std::string_view prefix, std::string_view command, std::string_view argument)
+{
+	std::lock_guard<std::mutex> bufferGuard(_bufferMutex);
+	_buffer.append(prefix).append(command).append(argument).push_back('\n');
+	_bufferedFrames++;
+	_appended++;
+}
+
+void CommandBuffer::append(std::string_view lines)
+{
+	std::lock_guard<std::mutex> bufferGuard(_bufferMutex);
+	_buffer.append(lines);
+	_bufferedFrames += std::count(lines.begin(), lines.end(), '\n');
+	_appended++;
+}
+
+void CommandBuffer::flush()
+{
+	std::unique_lock<std::mutex> bufferGuard(_bufferMutex);
+	//Everything appended before this call needs to be written when flush() returns.
+	uint64_t target = _appended;
+	while(_flushing)
+	{
+		//Written by the flushing thread
+		if(_written >= target) return;
+		_flushedConditionVariable.wait(bufferGuard);
+	}
+	_flushing = true;
+	while(!_buffer.empty())
+	{
+		//Swapping keeps the capacity of both buffers, so nothing is allocated.
+		_writeBuffer.swap(_buffer);
+		_buffer.clear();
+		uint32_t frames = _bufferedFrames;
+		_bufferedFrames = 0;
+		uint64_t written = _appended;
+		bufferGuard.unlock();
+		int32_t systemCalls = -1;
+		try
+		{
+			systemCalls = _writer(_writeBuffer);
+		}
+		catch(...)
+		{
+			_writeBuffer.clear();
+			bufferGuard.lock();
+			_flushing = false;
+			bufferGuard.unlock();
+			//Waiting threads write their commands themselves now
+			_flushedConditionVariable.notify_all();
+			throw;
+		}
+		_writeBuffer.clear();
+		if(systemCalls > 0)
+		{
+			_frames += frames;
+			_systemCalls += systemCalls;
+		}
+		bufferGuard.lock();
+		//Also set on errors. The commands are gone, there is nothing left to wait for.
+		_written = written;
+		_flushedConditionVariable.notify_all();
+	}
+	_flushing = false;
+	_flushedConditionVariable.notify_all();
+}
+
+void CommandBuffer::clear()
+{
+	std::lock_guard<std::mutex> bufferGuard(_bufferMutex);
+	_buffer.clear();
+	_bufferedFrames = 0;
+}
+
+}
@@ -0,0 +1,86 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef HOMEGEAR_MAX_COMMANDBUFFER_H
+#define HOMEGEAR_MAX_COMMANDBUFFER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace MAX
+{
+
+//Output buffer for line based interfaces like culfw. Commands are assembled in the buffer without temporary strings.
+//flush() hands everything buffered to the writer at once. When another thread is flushing already, that thread writes the
+//new commands with its next call, so commands of concurrent senders share system calls. flush() returns when the
+//commands appended before it was called are written, so callers can rely on the order (e. g. before closing the device).
+class CommandBuffer
+{
+public:
+	//Writes "data" to the device. Returns the number of system calls needed or -1 on errors.
+	typedef std::function<int32_t(const std::string& data)> Writer;
+
+	CommandBuffer(Writer writer);
+	virtual ~CommandBuffer() {}
+
+	//Appends "prefix", "command" and "argument" followed by "\n"
+	void append(std::string_view prefix, std::string_view command, std::string_view argument = std::string_view());
+	//Appends complete lines
+	void append(std::string_view lines);
+	void flush();
+	//Drops commands which were not written yet
+	void clear();
+
+	//Number of lines written and system calls used for them
+	uint64_t frames() { return _frames; }
+	uint64_t systemCalls() { return _systemCalls; }
+protected:
+	Writer _writer;
+	std::mutex _bufferMutex;
+	std::string _buffer;
+	uint32_t _bufferedFrames = 0;
+	//Only accessed by the flushing thread
+	std::string _writeBuffer;
+	bool _flushing = false;
+	//Number of append() calls and number of these that were handed to the writer
+	uint64_t _appended = 0;
+	uint64_t _written = 0;
+	std::condition_variable _flushedConditionVariable;
+	std::atomic<uint64_t> _frames{0};
+	std::atomic<uint64_t> _systemCalls{0};
+};
+
+}
+
+#endif
@@ -34,7 +34,7 @@
 
 namespace MAX {
 
-Cunx::Cunx(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IMaxInterface(settings) {
+Cunx::Cunx(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IMaxInterface(settings), _lineReader(1024), _commandBuffer(std::bind(&Cunx::writeBuffer, this, std::placeholders::_1)) {
   _out.init(GD::bl);
   _out.setPrefix(GD::out.getPrefix() + "CUNX \"" + settings->id + "\": ");
 
@@ -68,26 +68,20 @@ Cunx::~Cunx() {
   try {
     _stopCallbackThread = true;
     GD::bl->threadManager.join(_listenThread);
+    stopTx();
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
-void Cunx::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet) {
+void Cunx::transmit(std::shared_ptr<MAXPacket> maxPacket) {
   try {
-    if (!packet) {
-      _out.printWarning("Warning: Packet was nullptr.");
-      return;
-    }
     if (!isOpen()) {
       _out.printWarning(std::string("Warning: !!!Not!!! sending packet, because device is not connected or opened."));
       return;
     }
 
-    std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
-    if (!maxPacket) return;
-
     if (maxPacket->payload().size() > 54) {
       if (_bl->debugLevel >= 2) _out.printError("Error: Tried to send packet larger than 64 bytes. That is not supported.");
       return;
@@ -95,9 +89,14 @@ void Cunx::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet) {
 
     std::string packetHex = maxPacket->hexString();
     if (_bl->debugLevel > 3) _out.printInfo("Info: Sending (" + _settings->id + ", WOR: " + (maxPacket->getBurst() ? "yes" : "no") + "): " + packetHex);
-    if (maxPacket->getBurst()) send(stackPrefix + "Zs" + packetHex + "\n");
-    else send(stackPrefix + "Zf" + packetHex + "\n");
-    if (maxPacket->getBurst()) std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    if (maxPacket->getBurst()) {
+      _commandBuffer.append(stackPrefix, "Zs", packetHex);
+      send();
+      startBurst(1100);
+    } else {
+      _commandBuffer.append(stackPrefix, "Zf", packetHex);
+      send();
+    }
     _lastPacketSent = BaseLib::HelperFunctions::getTime();
   }
   catch (const std::exception &ex) {
@@ -105,18 +104,28 @@ void Cunx::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet) {
   }
 }
 
-void Cunx::send(std::string data) {
+void Cunx::send() {
+  try {
+    _commandBuffer.flush();
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+int32_t Cunx::writeBuffer(const std::string &data) {
   try {
-    if (data.size() < 3) return; //Otherwise error in printInfo
     _sendMutex.lock();
     if (!_socket->Connected() || _stopped) {
-      _out.printWarning(std::string("Warning: !!!Not!!! sending: ") + data.substr(2, data.size() - 3));
+      std::string commands(data);
+      BaseLib::HelperFunctions::trim(commands);
+      _out.printWarning(std::string("Warning: !!!Not!!! sending: ") + commands);
       _sendMutex.unlock();
-      return;
+      return -1;
     }
     _socket->Send((uint8_t *)data.data(), data.size());
     _sendMutex.unlock();
-    return;
+    return 1;
   }
   catch (const C1Net::Exception &ex) {
     _out.printError(ex.what());
@@ -126,6 +135,13 @@ void Cunx::send(std::string data) {
   }
   _stopped = true;
   _sendMutex.unlock();
+  return -1;
+}
+
+bool Cunx::getWriteStatistics(uint64_t &frames, uint64_t &systemCalls) {
+  frames = _commandBuffer.frames();
+  systemCalls = _commandBuffer.systemCalls();
+  return true;
 }
 
 void Cunx::startListening() {
@@ -165,11 +181,11 @@ void Cunx::reconnect() {
     _hostname = _settings->host;
     _ipAddress = _socket->GetIpAddress();
     _stopped = false;
-    send(stackPrefix + "X21\n");
-    send(stackPrefix + "Zr\n");
-    if (!_additionalCommands.empty()) send(_additionalCommands); // _additionalCommands already contain stackPrefix
-    _out.printInfo("Sent: " + _additionalCommands);
-    _out.printInfo("Connected to CUNX device with hostname " + _settings->host + " on port " + _settings->port + ".");
+    //The initialization commands are sent by processLine() when the CUNX answers
+    startHandshake();
+    _commandBuffer.clear(); //Commands for the old connection
+    _commandBuffer.append(stackPrefix, "V");
+    send();
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -178,9 +194,14 @@ void Cunx::reconnect() {
 
 void Cunx::stopListening() {
   try {
-    if (_socket->Connected()) send(stackPrefix + "Zx\nX00\n");
+    if (_socket->Connected()) {
+      _commandBuffer.append(stackPrefix, "Zx");
+      _commandBuffer.append(stackPrefix, "X00");
+      send();
+    }
     _stopCallbackThread = true;
     GD::bl->threadManager.join(_listenThread);
+    stopTx();
     _stopCallbackThread = false;
     _socket->Shutdown();
     _stopped = true;
@@ -194,54 +215,52 @@ void Cunx::stopListening() {
 
 void Cunx::listen() {
   try {
-    uint32_t receivedBytes = 0;
-    int32_t bufferMax = 2048;
-    std::vector<char> buffer(bufferMax);
     bool more_data = false;
 
     while (!_stopCallbackThread) {
       if (_stopped || !_socket->Connected()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        if (_stopCallbackThread) return;
+        if (!interruptibleSleep(nextReconnectDelay())) return;
         if (_stopped) _out.printWarning("Warning: Connection to CUNX closed. Trying to reconnect...");
+        _lineReader.clear(); //Don't combine a partial line with data of the new connection
         reconnect();
         continue;
       }
-      std::vector<uint8_t> data;
+      size_t bufferSize = 0;
+      char* buffer = _lineReader.prepare(bufferSize);
+      size_t receivedBytes = 0;
       try {
-        do {
-          receivedBytes = _socket->Read((uint8_t *)buffer.data(), buffer.size(), more_data);
-          if (receivedBytes > 0) {
-            data.insert(data.end(), buffer.begin(), buffer.begin() + receivedBytes);
-            if (data.size() > 1000000) {
-              _out.printError("Could not read from CUNX: Too much data.");
-              break;
-            }
-          }
-        } while (receivedBytes == (unsigned)bufferMax);
+        //Returns as soon as data is available, so every line is dispatched right away.
+        receivedBytes = _socket->Read((uint8_t *)buffer, bufferSize, more_data);
       }
       catch (const C1Net::TimeoutException &ex) {
-        if (data.empty()) continue; //When receivedBytes is exactly 2048 bytes long, proofread will be called again, time out and the packet is received with a delay of 5 seconds. It doesn't matter as packets this big are only received at start up.
+        if (handshakeExpired(15000)) {
+          _stopped = true;
+          _out.printWarning("Warning: CUNX didn't answer the version query.");
+        } else if (handshakePending()) {
+          _commandBuffer.append(stackPrefix, "V");
+          send();
+        }
+        continue;
       }
+      //Reconnects are delayed by the backoff in the loop above
       catch (const C1Net::ClosedException &ex) {
         _stopped = true;
         _out.printWarning("Warning: " + std::string(ex.what()));
-        std::this_thread::sleep_for(std::chrono::milliseconds(10000));
         continue;
       }
       catch (const C1Net::Exception &ex) {
         _stopped = true;
         _out.printError("Error: " + std::string(ex.what()));
-        std::this_thread::sleep_for(std::chrono::milliseconds(10000));
         continue;
       }
-      if (data.empty() || data.size() > 1000000) continue;
+      if (receivedBytes == 0) continue;
+      _lineReader.commit(receivedBytes);
 
       if (_bl->debugLevel >= 6) {
-        _out.printDebug("Debug: Packet received from CUNX. Raw data: " + BaseLib::HelperFunctions::getHexString(data));
+        _out.printDebug("Debug: Packet received from CUNX. Raw data: " + BaseLib::HelperFunctions::getHexString(buffer, receivedBytes));
       }
 
-      processData(data);
+      processData();
 
       _lastPacketReceived = BaseLib::HelperFunctions::getTime();
     }
@@ -251,31 +270,52 @@ void Cunx::listen() {
   }
 }
 
-void Cunx::processData(std::vector<uint8_t> &data) {
+void Cunx::processData() {
   try {
-    if (data.empty()) return;
-    std::string packets;
-    packets.insert(packets.end(), data.begin(), data.end());
+    std::string_view line;
+    while (_lineReader.nextLine(line)) {
+      line.remove_suffix(1); //"\n"
+      processLine(line);
+    }
+    if (_lineReader.overflow()) {
+      _out.printError("Error: Line received from CUNX is too long. Discarding it.");
+      _lineReader.clear();
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
 
-    std::istringstream stringStream(packets);
-    std::string packetHex;
-    while (std::getline(stringStream, packetHex)) {
-      if (stackPrefix.empty()) {
-        if (packetHex.size() > 0 && packetHex.at(0) == '*') return;
-      } else {
-        if (packetHex.size() + 1 <= stackPrefix.size()) return;
-        if (packetHex.substr(0, stackPrefix.size()) != stackPrefix || packetHex.at(stackPrefix.size()) == '*') return;
-        else packetHex = packetHex.substr(stackPrefix.size());
-      }
-      if (packetHex.size() > 21) //21 is minimal packet length (=10 Byte + CUNX "Z" + "\n")
-      {
-        std::shared_ptr<MAXPacket> packet(new MAXPacket(packetHex, BaseLib::HelperFunctions::getTime()));
-        raisePacketReceived(packet);
-      } else if (!packetHex.empty()) {
-        if (packetHex.compare(0, 4, "LOVF") == 0) _out.printWarning("Warning: CUNX with id " + _settings->id + " reached 1% limit. You need to wait, before sending is allowed again.");
-        else if (packetHex == "Z") continue;
-        else _out.printWarning("Warning: Too short packet received: " + packetHex);
-      }
+void Cunx::processLine(std::string_view packetHex) {
+  try {
+    if (stackPrefix.empty()) {
+      if (packetHex.size() > 0 && packetHex.at(0) == '*') return;
+    } else {
+      if (packetHex.size() + 1 <= stackPrefix.size()) return;
+      if (packetHex.compare(0, stackPrefix.size(), stackPrefix) != 0 || packetHex.at(stackPrefix.size()) == '*') return;
+      else packetHex.remove_prefix(stackPrefix.size());
+    }
+    bool handshakeCompleted = false;
+    if (handshakeReply(packetHex, handshakeCompleted)) {
+      if (!handshakeCompleted) return;
+      _commandBuffer.append(stackPrefix, "X21");
+      _commandBuffer.append(stackPrefix, "Zr");
+      if (!_additionalCommands.empty()) _commandBuffer.append(_additionalCommands); // _additionalCommands already contain stackPrefix
+      send();
+      _out.printInfo("Sent: " + _additionalCommands);
+      _out.printInfo("Connected to CUNX device with hostname " + _settings->host + " on port " + _settings->port + ".");
+      resetReconnectDelay();
+      return;
+    }
+    if (packetHex.size() > 21) //21 is minimal packet length (=10 Byte + CUNX "Z" + "\n")
+    {
+      std::shared_ptr<MAXPacket> packet(new MAXPacket(packetHex, BaseLib::HelperFunctions::getTime()));
+      raisePacketReceived(packet);
+    } else if (!packetHex.empty()) {
+      if (packetHex.compare(0, 4, "LOVF") == 0) _out.printWarning("Warning: CUNX with id " + _settings->id + " reached 1% limit. You need to wait, before sending is allowed again.");
+      else if (packetHex == "Z") return;
+      else _out.printWarning("Warning: Too short packet received: " + std::string(packetHex));
     }
   }
   catch (const std::exception &ex) {
@@ -32,6 +32,10 @@
 
 #include <homegear-base/BaseLib.h>
 #include "IMaxInterface.h"
+#include "CommandBuffer.h"
+#include "LineReader.h"
+
+#include <string_view>
 
 namespace MAX
 {
@@ -43,17 +47,26 @@ class Cunx : public IMaxInterface
         virtual ~Cunx();
         void startListening();
         void stopListening();
-        void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
         virtual bool isOpen() { return _socket->Connected(); }
+        virtual bool getWriteStatistics(uint64_t& frames, uint64_t& systemCalls);
     protected:
         BaseLib::Output _out;
         std::string _port;
         std::unique_ptr<C1Net::TcpSocket> _socket;
         std::string stackPrefix;
+        CommandBuffer _commandBuffer;
+        //Only accessed by the listen thread
+        LineReader _lineReader;
 
+        void transmit(std::shared_ptr<MAXPacket> packet);
         void reconnect();
-        void processData(std::vector<uint8_t>& data);
-        void send(std::string data);
+        //Dispatches all complete lines in _lineReader. Incomplete lines stay buffered until the next read.
+        void processData();
+        void processLine(std::string_view packetHex);
+        //Sends the commands in _commandBuffer
+        void send();
+        //Writer of _commandBuffer
+        int32_t writeBuffer(const std::string& data);
         std::string readFromDevice();
         void listen();
     private:
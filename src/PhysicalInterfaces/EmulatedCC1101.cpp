@@ -0,0 +1,154 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "EmulatedCC1101.h"
+
+#ifdef SPIINTERFACES
+#include "../GD.h"
+
+#include <sys/eventfd.h>
+
+namespace MAX
+{
+
+EmulatedCC1101::EmulatedCC1101(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : TICC1100(settings)
+{
+	try
+	{
+		_out.setPrefix(GD::out.getPrefix() + "Emulated TI CC110X \"" + settings->id + "\": ");
+
+		//There is no hardware to keep up with, so the listen thread doesn't need real time priority
+		_settings->listenThreadPriority = -1;
+		_model.setInterruptPin(_settings->interruptPin);
+		_model.setTransmitHandler([this](const std::vector<uint8_t>& packet)
+		{
+			if(_bl->debugLevel >= 4) _out.printInfo("Info: Emulated chip transmitted: " + BaseLib::HelperFunctions::getHexString(packet));
+		});
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+EmulatedCC1101::~EmulatedCC1101()
+{
+	try
+	{
+		//mainThread and the TX thread call the virtual methods, so they need to be stopped before this object is gone.
+		_stopCallbackThread = true;
+		_bl->threadManager.join(_listenThread);
+		stopTx();
+		closeDevice();
+		closeInterrupt();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void EmulatedCC1101::openDevice()
+{
+	try
+	{
+		if(_fileDescriptor->descriptor != -1) closeDevice();
+		//The descriptor is only a placeholder, so the validity checks of the driver work as usual.
+		_fileDescriptor = _bl->fileDescriptorManager.add(eventfd(0, EFD_CLOEXEC));
+		if(_fileDescriptor->descriptor == -1)
+		{
+			_out.printCritical("Couldn't create event descriptor: " + std::string(strerror(errno)));
+			return;
+		}
+		_model.reset();
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void EmulatedCC1101::closeDevice()
+{
+	try
+	{
+		_bl->fileDescriptorManager.close(_fileDescriptor);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool EmulatedCC1101::openInterrupt()
+{
+	try
+	{
+		closeInterrupt();
+		_gpioDescriptors[1] = _bl->fileDescriptorManager.add(eventfd(0, EFD_CLOEXEC));
+		return _gpioDescriptors[1]->descriptor != -1;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+void EmulatedCC1101::closeInterrupt()
+{
+	try
+	{
+		if(_gpioDescriptors[1]) _bl->fileDescriptorManager.close(_gpioDescriptors[1]);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool EmulatedCC1101::spiTransfer(struct spi_ioc_transfer* transfers, uint32_t count)
+{
+	for(uint32_t i = 0; i < count; i++)
+	{
+		uint8_t* data = (uint8_t*)transfers[i].rx_buf;
+		if(!data) return false;
+		if(transfers[i].tx_buf != transfers[i].rx_buf) memcpy(data, (uint8_t*)transfers[i].tx_buf, transfers[i].len);
+		_model.transfer(data, transfers[i].len);
+	}
+	return true;
+}
+
+int32_t EmulatedCC1101::waitForInterrupt(int32_t timeout, bool& high)
+{
+	return _model.waitForEdge(timeout, high);
+}
+
+}
+#endif
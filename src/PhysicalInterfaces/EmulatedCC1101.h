@@ -0,0 +1,69 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef HOMEGEAR_MAX_EMULATEDCC1101_H
+#define HOMEGEAR_MAX_EMULATEDCC1101_H
+
+#include "../../config.h"
+#include "TICC1100.h"
+
+#ifdef SPIINTERFACES
+
+#include "Cc1101Model.h"
+
+namespace MAX
+{
+
+//TI CC1101 driver running against Cc1101Model instead of spidev and a GPIO. The driver code (state machine, FIFO
+//handling, burst sending) is the same as for real hardware, so it can be exercised on any Linux system. Packets are
+//injected with model().receive() and transmitted packets are printed on debug level 4.
+class EmulatedCC1101 : public TICC1100
+{
+public:
+	EmulatedCC1101(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings);
+	virtual ~EmulatedCC1101();
+
+	virtual void setup(int32_t userID, int32_t groupID, bool setPermissions) {}
+	Cc1101Model& model() { return _model; }
+protected:
+	Cc1101Model _model;
+
+	virtual void openDevice();
+	virtual void closeDevice();
+	virtual void setupDevice() {}
+	virtual bool openInterrupt();
+	virtual void closeInterrupt();
+	virtual bool spiTransfer(struct spi_ioc_transfer* transfers, uint32_t count);
+	virtual int32_t waitForInterrupt(int32_t timeout, bool& high);
+};
+
+}
+
+#endif
+#endif
@@ -13,7 +13,9 @@ HomegearGateway::HomegearGateway(std::shared_ptr<BaseLib::Systems::PhysicalInter
   signal(SIGPIPE, SIG_IGN);
 
   _stopped = true;
-  _waitForResponse = false;
+
+  int32_t pipelineDepth = BaseLib::Math::getNumber(GD::settings->getString("gatewaypipelinedepth"));
+  if (pipelineDepth > 1) _pipelineDepth = pipelineDepth > 64 ? 64 : pipelineDepth;
 
   _binaryRpc.reset(new BaseLib::Rpc::BinaryRpc(_bl));
   _rpcEncoder.reset(new BaseLib::Rpc::RpcEncoder(_bl, true, true));
@@ -72,6 +74,7 @@ void HomegearGateway::stopListening() {
     if (_tcpSocket) _tcpSocket->Shutdown();
     _bl->threadManager.join(_listenThread);
     _stopped = true;
+    failRequests("Connection closed.");
     _tcpSocket.reset();
     IPhysicalInterface::stopListening();
   }
@@ -93,7 +96,7 @@ void HomegearGateway::listen() {
       _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
 
-    std::vector<char> buffer(1024);
+    std::vector<char> buffer(4096);
     int32_t processedBytes = 0;
     bool more_data = false;
     while (!_stopCallbackThread) {
@@ -102,6 +105,7 @@ void HomegearGateway::listen() {
           if (_stopCallbackThread) return;
           if (_stopped) _out.printWarning("Warning: Connection to device closed. Trying to reconnect...");
           _tcpSocket->Shutdown();
+          failRequests("Connection closed.");
           std::this_thread::sleep_for(std::chrono::milliseconds(1000));
           _tcpSocket->Open();
           if (_tcpSocket->Connected()) {
@@ -119,7 +123,7 @@ void HomegearGateway::listen() {
           continue;
         }
         if (bytesRead <= 0) continue;
-        if (bytesRead > 1024) bytesRead = 1024;
+        if (bytesRead > (signed)buffer.size()) bytesRead = buffer.size();
 
         if (GD::bl->debugLevel >= 5) _out.printDebug("Debug: TCP packet received: " + BaseLib::HelperFunctions::getHexString(buffer.data(), bytesRead));
 
@@ -140,11 +144,8 @@ void HomegearGateway::listen() {
                 std::vector<uint8_t> data;
                 _rpcEncoder->encodeResponse(response, data);
                 _tcpSocket->Send(data);
-              } else if (_binaryRpc->getType() == BaseLib::Rpc::BinaryRpc::Type::response && _waitForResponse) {
-                std::unique_lock<std::mutex> requestLock(_requestMutex);
-                _rpcResponse = _rpcDecoder->decodeResponse(_binaryRpc->getData());
-                requestLock.unlock();
-                _requestConditionVariable.notify_all();
+              } else if (_binaryRpc->getType() == BaseLib::Rpc::BinaryRpc::Type::response) {
+                processResponse(_rpcDecoder->decodeResponse(_binaryRpc->getData()));
               }
               _binaryRpc->reset();
             }
@@ -188,9 +189,11 @@ void HomegearGateway::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packe
 
     if (_bl->debugLevel >= 4) _out.printInfo("Info: Sending: " + parameters->at(1)->stringValue);
 
-    auto result = invoke("sendPacket", parameters);
+    //When pipelining, errors are logged when the response arrives.
+    bool wait = _pipelineDepth <= 1;
+    auto result = invoke("sendPacket", parameters, wait, parameters->at(1)->stringValue);
     if (result->errorStruct) {
-      _out.printError("Error sending packet " + maxPacket->hexString() + ": " + result->structValue->at("faultString")->stringValue);
+      _out.printError("Error sending packet " + parameters->at(1)->stringValue + ": " + result->structValue->at("faultString")->stringValue);
     }
 
     _lastPacketSent = BaseLib::HelperFunctions::getTime();
@@ -200,39 +203,71 @@ void HomegearGateway::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packe
   }
 }
 
-PVariable HomegearGateway::invoke(std::string methodName, PArray &parameters) {
+PVariable HomegearGateway::invoke(const std::string &methodName, PArray &parameters, bool wait, const std::string &packetHex) {
   try {
-    std::lock_guard<std::mutex> invokeGuard(_invokeMutex);
-
-    std::unique_lock<std::mutex> requestLock(_requestMutex);
-    _rpcResponse.reset();
-    _waitForResponse = true;
+    PRequest request = std::make_shared<Request>();
+    request->method = methodName;
+    request->waiting = wait;
+    request->packetHex = packetHex;
+
+    {
+      std::lock_guard<std::mutex> invokeGuard(_invokeMutex);
+
+      {
+        std::unique_lock<std::mutex> requestLock(_requestMutex);
+        if (!_requestConditionVariable.wait_for(requestLock, std::chrono::milliseconds(10000), [&] { return _requests.size() < _pipelineDepth || _stopped; })) {
+          requestLock.unlock();
+          //Late responses to the open requests would be matched to the next requests. Closing the connection makes sure
+          //they never arrive. The listen thread or the send loop below reconnects.
+          _out.printWarning("Warning: Gateway didn't answer " + std::to_string(_pipelineDepth) + " request(s) within 10 seconds. Reconnecting...");
+          _tcpSocket->Shutdown();
+          failRequests("No RPC response received.");
+          requestLock.lock();
+        }
+        //No check for _stopped here: Like before pipelining, Send() below is tried and the socket reopened on errors.
+        _requests.push_back(request);
+      }
 
-    std::vector<uint8_t> encodedPacket;
-    _rpcEncoder->encodeRequest(methodName, parameters, encodedPacket);
+      _encodedRequest.clear();
+      _rpcEncoder->encodeRequest(methodName, parameters, _encodedRequest);
 
-    int32_t i = 0;
-    for (i = 0; i < 5; i++) {
-      try {
-        _tcpSocket->Send(encodedPacket);
-        break;
-      }
-      catch (const C1Net::Exception &ex) {
-        _out.printError("Error: " + std::string(ex.what()));
-        if (i == 5) return BaseLib::Variable::createError(-32500, ex.what());
-        _tcpSocket->Open();
+      int32_t i = 0;
+      for (i = 0; i < 5; i++) {
+        try {
+          _tcpSocket->Send(_encodedRequest);
+          break;
+        }
+        catch (const C1Net::Exception &ex) {
+          _out.printError("Error: " + std::string(ex.what()));
+          if (i == 4) {
+            std::lock_guard<std::mutex> requestGuard(_requestMutex);
+            auto requestIterator = std::find(_requests.begin(), _requests.end(), request);
+            if (requestIterator != _requests.end()) _requests.erase(requestIterator);
+            return BaseLib::Variable::createError(-32500, ex.what());
+          }
+          //Requests sent on the old connection won't be answered on the new one
+          failRequests("Connection closed.", request);
+          _tcpSocket->Open();
+        }
       }
     }
 
-    i = 0;
+    if (!wait) return std::make_shared<BaseLib::Variable>();
+
+    std::unique_lock<std::mutex> requestLock(_requestMutex);
+    int32_t i = 0;
     while (!_requestConditionVariable.wait_for(requestLock, std::chrono::milliseconds(1000), [&] {
       i++;
-      return _rpcResponse || _stopped || i == 10;
+      return request->finished || _stopped || i == 10;
     }));
-    _waitForResponse = false;
-    if (i == 10 || !_rpcResponse) return BaseLib::Variable::createError(-32500, "No RPC response received.");
+    if (!request->finished) {
+      //The request stays in _requests, so a late response is matched to it and not to the next request.
+      request->abandoned = true;
+      return BaseLib::Variable::createError(-32500, "No RPC response received.");
+    }
+    if (!request->response) return BaseLib::Variable::createError(-32500, "No RPC response received.");
 
-    return _rpcResponse;
+    return request->response;
   }
   catch (const std::exception &ex) {
     _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -240,6 +275,59 @@ PVariable HomegearGateway::invoke(std::string methodName, PArray &parameters) {
   return BaseLib::Variable::createError(-32500, "Unknown application error. See log for more details.");
 }
 
+void HomegearGateway::processResponse(BaseLib::PVariable response) {
+  try {
+    PRequest request;
+    {
+      std::lock_guard<std::mutex> requestGuard(_requestMutex);
+      if (_requests.empty()) {
+        _out.printWarning("Warning: Received RPC response without request.");
+        return;
+      }
+      request = _requests.front();
+      _requests.pop_front();
+      request->response = response;
+      request->finished = true;
+    }
+    _requestConditionVariable.notify_all();
+
+    if (request->abandoned && _bl->debugLevel >= 4) _out.printInfo("Info: Late response received for " + request->method + ".");
+    if ((!request->waiting || request->abandoned) && response && response->errorStruct) {
+      auto faultStringIterator = response->structValue->find("faultString");
+      _out.printError("Error sending packet " + request->packetHex + ": " + (faultStringIterator != response->structValue->end() ? faultStringIterator->second->stringValue : std::string("Unknown error.")));
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void HomegearGateway::failRequests(const std::string &reason, const PRequest &except) {
+  try {
+    std::deque<PRequest> requests;
+    {
+      std::lock_guard<std::mutex> requestGuard(_requestMutex);
+      requests.swap(_requests);
+      if (except) {
+        auto requestIterator = std::find(requests.begin(), requests.end(), except);
+        if (requestIterator != requests.end()) {
+          requests.erase(requestIterator);
+          _requests.push_back(except);
+        }
+      }
+      for (auto &request : requests) {
+        request->response = BaseLib::Variable::createError(-32500, reason);
+        request->finished = true;
+      }
+    }
+    _requestConditionVariable.notify_all();
+    if (!requests.empty()) _out.printWarning("Warning: " + std::to_string(requests.size()) + " request(s) were not answered: " + reason);
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 void HomegearGateway::processPacket(std::string &data) {
   try {
     if (data.size() < 9) {
@@ -7,6 +7,9 @@
 #include "IMaxInterface.h"
 #include <homegear-base/BaseLib.h>
 
+#include <algorithm>
+#include <deque>
+
 namespace MAX
 {
 
@@ -28,15 +31,40 @@ protected:
     std::unique_ptr<BaseLib::Rpc::RpcEncoder> _rpcEncoder;
     std::unique_ptr<BaseLib::Rpc::RpcDecoder> _rpcDecoder;
 
+    class Request
+    {
+    public:
+        std::string method;
+        //Used to log errors of requests nobody waits for.
+        std::string packetHex;
+        bool waiting = false;
+        //Set when the caller stopped waiting. The request is kept in _requests until its response arrives.
+        bool abandoned = false;
+        bool finished = false;
+        BaseLib::PVariable response;
+    };
+    typedef std::shared_ptr<Request> PRequest;
+
     std::thread _initThread;
+    //Serializes sending, so requests are sent in the order of _requests.
     std::mutex _invokeMutex;
+    std::vector<uint8_t> _encodedRequest;
     std::mutex _requestMutex;
-    std::atomic_bool _waitForResponse;
     std::condition_variable _requestConditionVariable;
-    BaseLib::PVariable _rpcResponse;
+    //Requests sent but not answered yet. Binary RPC has no request ID, but the gateway answers in order, so a
+    //response always belongs to the oldest request. Timed out requests are therefore never removed from the middle,
+    //only by a response or by failRequests() when the connection is replaced.
+    std::deque<PRequest> _requests;
+    //Maximum number of unanswered requests. With 1 every packet waits for its response.
+    uint32_t _pipelineDepth = 1;
 
     void listen();
-    PVariable invoke(std::string methodName, PArray& parameters);
+    //With "wait" set to false, invoke() returns as soon as the request is sent. "packetHex" is logged when the
+    //request fails.
+    PVariable invoke(const std::string& methodName, PArray& parameters, bool wait = true, const std::string& packetHex = "");
+    void processResponse(BaseLib::PVariable response);
+    //Finishes all unanswered requests but "except" with an error, e. g. when the connection is closed.
+    void failRequests(const std::string& reason, const PRequest& except = PRequest());
     void processPacket(std::string& data);
 };
 
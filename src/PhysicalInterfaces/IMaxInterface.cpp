@@ -28,12 +28,13 @@
  */
 
 #include "IMaxInterface.h"
+#include "../MAXPacket.h"
 #include "../GD.h"
 
 namespace MAX
 {
 
-IMaxInterface::IMaxInterface(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IPhysicalInterface(GD::bl, GD::family->getFamily(), settings)
+IMaxInterface::IMaxInterface(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings) : IPhysicalInterface(GD::bl, MAX_FAMILY_ID, settings)
 {
     _bl = GD::bl;
 
@@ -53,7 +54,264 @@ IMaxInterface::IMaxInterface(std::shared_ptr<BaseLib::Systems::PhysicalInterface
 
 IMaxInterface::~IMaxInterface()
 {
+	stopTx();
+}
+
+bool IMaxInterface::txReady(const std::shared_ptr<MAXPacket>& packet, int64_t time)
+{
+	if(_txBusyUntil != 0) return false;
+	return !packet->getBurst() || time >= _lastTxCompleted + _burstGap;
+}
+
+void IMaxInterface::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
+{
+	try
+	{
+		std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
+		if(!maxPacket)
+		{
+			if(!packet) GD::out.printWarning("Warning: Packet was nullptr.");
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+			if(!_txQueue.empty() || !txReady(maxPacket, BaseLib::HelperFunctions::getTime()))
+			{
+				_txQueue.push_back(maxPacket);
+				if(!_txThread.joinable()) GD::bl->threadManager.start(_txThread, true, &IMaxInterface::txThread, this);
+				_txQueueConditionVariable.notify_one();
+				return;
+			}
+			//Keeps other callers from transmitting until the burst is started
+			if(maxPacket->getBurst()) _txBusyUntil = INT64_MAX;
+		}
+		transmitPacket(maxPacket);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool IMaxInterface::txIdle()
+{
+	std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+	return _txBusyUntil == 0 && _txQueue.empty();
+}
+
+void IMaxInterface::transmitPacket(std::shared_ptr<MAXPacket> packet)
+{
+	try
+	{
+		transmit(packet);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+	if(!packet->getBurst()) _lastTxCompleted = BaseLib::HelperFunctions::getTime();
+	else if(_txBusyUntil == INT64_MAX) _txBusyUntil = 0; //The driver didn't start the burst
+	if(!_txQueue.empty()) _txQueueConditionVariable.notify_one();
+}
+
+void IMaxInterface::startBurst(int64_t duration, std::function<void()> completion)
+{
+	try
+	{
+		std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+		_txBusyUntil = BaseLib::HelperFunctions::getTime() + duration;
+		_burstCompletion = std::move(completion);
+		if(!_txThread.joinable()) GD::bl->threadManager.start(_txThread, true, &IMaxInterface::txThread, this);
+		_txQueueConditionVariable.notify_one();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void IMaxInterface::txCompleted()
+{
+	std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+	_lastTxCompleted = BaseLib::HelperFunctions::getTime();
+	//A pending or running completion (e. g. the payload of a burst) still needs to be sent. The TX thread clears
+	//_txBusyUntil after a running completion returns.
+	if(!_burstCompletion && _txBusyUntil != INT64_MAX) _txBusyUntil = 0;
+	_txQueueConditionVariable.notify_one();
+}
 
+void IMaxInterface::stopTx()
+{
+	try
+	{
+		_stopTxThread = true;
+		{
+			std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+			_txQueueConditionVariable.notify_one();
+		}
+		GD::bl->threadManager.join(_txThread);
+		std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+		_stopTxThread = false;
+		_txQueue.clear();
+		_burstCompletion = std::function<void()>();
+		_txBusyUntil = 0;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void IMaxInterface::txThread()
+{
+	try
+	{
+		while(!_stopTxThread)
+		{
+			std::function<void()> completion;
+			int64_t completionStarted = 0;
+			std::shared_ptr<MAXPacket> packet;
+			{
+				std::unique_lock<std::mutex> txQueueGuard(_txQueueMutex);
+				int64_t time = BaseLib::HelperFunctions::getTime();
+				if(_txBusyUntil != 0 && _txBusyUntil != INT64_MAX && time >= _txBusyUntil)
+				{
+					completion = std::move(_burstCompletion);
+					_burstCompletion = std::function<void()>();
+					if(completion)
+					{
+						//Stays busy while the completion runs and until the driver reports the end through txCompleted().
+						_txBusyUntil = INT64_MAX;
+						completionStarted = time;
+					}
+					else
+					{
+						//Without hardware report the end of the burst is the end of the transmission.
+						_lastTxCompleted = _txBusyUntil.load();
+						_txBusyUntil = 0;
+					}
+				}
+				else if(!_txQueue.empty() && txReady(_txQueue.front(), time))
+				{
+					packet = _txQueue.front();
+					_txQueue.pop_front();
+					if(packet->getBurst()) _txBusyUntil = INT64_MAX;
+				}
+				else
+				{
+					int64_t waitingTime = 1000;
+					if(_txBusyUntil != 0 && _txBusyUntil != INT64_MAX) waitingTime = _txBusyUntil - time;
+					else if(_txBusyUntil == 0 && !_txQueue.empty()) waitingTime = _lastTxCompleted + _burstGap - time;
+					if(waitingTime > 1000) waitingTime = 1000;
+					if(waitingTime > 0) _txQueueConditionVariable.wait_for(txQueueGuard, std::chrono::milliseconds(waitingTime));
+					continue;
+				}
+			}
+			if(completion)
+			{
+				try
+				{
+					completion();
+				}
+				catch(const std::exception& ex)
+				{
+					GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+				}
+				std::lock_guard<std::mutex> txQueueGuard(_txQueueMutex);
+				//txCompleted() was called while the completion was running
+				if(_lastTxCompleted >= completionStarted) _txBusyUntil = 0;
+				//Otherwise wait for txCompleted(). When it doesn't come (e. g. nothing was sent), the radio is assumed
+				//idle after _txCompletedTimeout like after a burst without completion.
+				else if(_txBusyUntil == INT64_MAX) _txBusyUntil = BaseLib::HelperFunctions::getTime() + _txCompletedTimeout;
+				_txQueueConditionVariable.notify_one();
+			}
+			if(packet) transmitPacket(packet);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void IMaxInterface::startHandshake()
+{
+	std::lock_guard<std::mutex> handshakeGuard(_handshakeMutex);
+	_handshakePending = true;
+	_handshakeStarted = BaseLib::HelperFunctions::getTime();
+}
+
+bool IMaxInterface::handshakeReply(std::string_view line, bool& completed)
+{
+	completed = false;
+	//E. g. "V 1.67 CUL868"
+	if(line.size() < 2 || line[0] != 'V' || line[1] != ' ') return false;
+	std::lock_guard<std::mutex> handshakeGuard(_handshakeMutex);
+	if(!_handshakePending) return true; //Answer to a repeated query
+	_handshakePending = false;
+	completed = true;
+	_handshakeConditionVariable.notify_all();
+	return true;
+}
+
+bool IMaxInterface::handshakePending()
+{
+	std::lock_guard<std::mutex> handshakeGuard(_handshakeMutex);
+	return _handshakePending;
+}
+
+bool IMaxInterface::handshakeExpired(int64_t timeout)
+{
+	std::lock_guard<std::mutex> handshakeGuard(_handshakeMutex);
+	return _handshakePending && BaseLib::HelperFunctions::getTime() - _handshakeStarted > timeout;
+}
+
+bool IMaxInterface::waitForHandshake(int64_t timeout, const std::function<void()>& sendQuery)
+{
+	try
+	{
+		int64_t endTime = BaseLib::HelperFunctions::getTime() + timeout;
+		std::unique_lock<std::mutex> handshakeGuard(_handshakeMutex);
+		while(_handshakePending)
+		{
+			int64_t waitingTime = endTime - BaseLib::HelperFunctions::getTime();
+			if(waitingTime <= 0 || _stopCallbackThread) return false;
+			if(waitingTime > 250) waitingTime = 250;
+			handshakeGuard.unlock();
+			sendQuery();
+			handshakeGuard.lock();
+			_handshakeConditionVariable.wait_for(handshakeGuard, std::chrono::milliseconds(waitingTime), [&] { return !_handshakePending; });
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+int64_t IMaxInterface::nextReconnectDelay()
+{
+	uint32_t attempts = _reconnectAttempts++;
+	if(attempts == 0) return 0;
+	int64_t delay = 1000 << std::min(attempts - 1, (uint32_t)6);
+	if(delay > 60000) delay = 60000;
+	return delay / 2 + BaseLib::HelperFunctions::getRandomNumber(0, delay / 2);
+}
+
+bool IMaxInterface::interruptibleSleep(int64_t duration)
+{
+	int64_t endTime = BaseLib::HelperFunctions::getTime() + duration;
+	while(!_stopCallbackThread)
+	{
+		int64_t waitingTime = endTime - BaseLib::HelperFunctions::getTime();
+		if(waitingTime <= 0) return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(waitingTime > 100 ? 100 : waitingTime));
+	}
+	return false;
 }
 
 }
@@ -32,8 +32,14 @@
 
 #include <homegear-base/BaseLib.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <string_view>
+
 namespace MAX
 {
+class MAXPacket;
 
 class IMaxInterface : public BaseLib::Systems::IPhysicalInterface
 {
@@ -44,11 +50,80 @@ public:
     virtual void startListening() {}
     virtual void stopListening() {}
 
-    virtual void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet) {}
+    //Transmits the packet right away when the radio is idle. During a wake-on-radio burst the packet is queued and
+    //transmitted by the TX thread afterwards, so the caller never waits for a burst.
+    virtual void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
+    bool txBusy() { return _txBusyUntil != 0; }
+    //True when no burst is running and no packet is waiting
+    bool txIdle();
+    //Time the last transmission ended. Reported by the hardware when supported.
+    int64_t lastTxCompleted() { return _lastTxCompleted; }
+    //Number of command lines written to the device and the system calls needed for them. Returns false when the
+    //interface doesn't write commands through a CommandBuffer.
+    virtual bool getWriteStatistics(uint64_t& frames, uint64_t& systemCalls) { return false; }
 protected:
     BaseLib::SharedObjects* _bl = nullptr;
     BaseLib::Output _out;
 	std::string _additionalCommands;
+
+	//Sends the packet to the hardware. Must not wait for a burst to finish, call startBurst() instead.
+	virtual void transmit(std::shared_ptr<MAXPacket> packet) {}
+	//Marks the radio as busy for "duration" milliseconds. "completion" is called from the TX thread afterwards. With a
+	//completion the radio stays busy until the driver calls txCompleted().
+	void startBurst(int64_t duration, std::function<void()> completion = std::function<void()>());
+	//Called by drivers when the hardware reports the end of a transmission.
+	void txCompleted();
+	//Stops the TX thread and drops queued packets. Needs to be called by drivers before they are destroyed.
+	void stopTx();
+
+	//{{{ Readiness handshake
+	//culfw answers the version query "V" as soon as it processes commands. Drivers send it after opening the device
+	//instead of waiting a fixed time and pass every received line to handshakeReply().
+	void startHandshake();
+	//Returns true when "line" is a version string. "completed" is set when it answers the running handshake.
+	bool handshakeReply(std::string_view line, bool& completed);
+	bool handshakePending();
+	//True when the handshake is running for more than "timeout" milliseconds
+	bool handshakeExpired(int64_t timeout);
+	//Waits up to "timeout" milliseconds for the handshake to complete. "sendQuery" is called right away and then every
+	//250 ms, as queries sent while the device starts up get lost.
+	bool waitForHandshake(int64_t timeout, const std::function<void()>& sendQuery);
+	//}}}
+
+	//{{{ Reconnect backoff
+	//Returns the time to wait before the next reconnect attempt in milliseconds. The first attempt is immediate, then the
+	//delay starts at one second and doubles up to one minute. Up to half of it is random, so interfaces don't retry in
+	//lock step.
+	int64_t nextReconnectDelay();
+	void resetReconnectDelay() { _reconnectAttempts = 0; }
+	//Returns false when _stopCallbackThread was set before "duration" milliseconds passed.
+	bool interruptibleSleep(int64_t duration);
+	//}}}
+private:
+	//Minimum time between the end of a transmission and the start of a burst
+	static const int64_t _burstGap = 100;
+	//Time to wait for txCompleted() after a burst completion returned
+	static const int64_t _txCompletedTimeout = 1000;
+
+	std::mutex _txQueueMutex;
+	std::condition_variable _txQueueConditionVariable;
+	std::deque<std::shared_ptr<MAXPacket>> _txQueue;
+	std::thread _txThread;
+	std::atomic_bool _stopTxThread{false};
+	//0 when idle, INT64_MAX while a burst is being started or its completion is running
+	std::atomic<int64_t> _txBusyUntil{0};
+	std::atomic<int64_t> _lastTxCompleted{0};
+	std::function<void()> _burstCompletion;
+
+	std::mutex _handshakeMutex;
+	std::condition_variable _handshakeConditionVariable;
+	bool _handshakePending = false;
+	int64_t _handshakeStarted = 0;
+	std::atomic<uint32_t> _reconnectAttempts{0};
+
+	bool txReady(const std::shared_ptr<MAXPacket>& packet, int64_t time);
+	void transmitPacket(std::shared_ptr<MAXPacket> packet);
+	void txThread();
 };
 
 }
@@ -0,0 +1,111 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "LineReader.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+namespace MAX
+{
+
+LineReader::LineReader(uint32_t maxLineLength)
+{
+	_maxLineLength = maxLineLength;
+	_buffer.resize(maxLineLength * 2 > 4096 ? maxLineLength * 2 : 4096);
+}
+
+void LineReader::clear()
+{
+	_start = 0;
+	_end = 0;
+	_searchPosition = 0;
+}
+
+void LineReader::compact()
+{
+	if(_start == 0) return;
+	if(_end > _start) memmove(_buffer.data(), _buffer.data() + _start, _end - _start);
+	_end -= _start;
+	_searchPosition -= _start;
+	_start = 0;
+}
+
+char* LineReader::prepare(size_t& size)
+{
+	//Lines handed out before are invalidated here, so the buffer can be reused.
+	if(_end == _buffer.size() || _buffer.size() - _end < _maxLineLength) compact();
+	size = _buffer.size() - _end;
+	return _buffer.data() + _end;
+}
+
+ssize_t LineReader::read(int32_t fileDescriptor)
+{
+	size_t size = 0;
+	char* buffer = prepare(size);
+	if(size == 0)
+	{
+		errno = ENOBUFS;
+		return -1;
+	}
+	ssize_t bytesRead = ::read(fileDescriptor, buffer, size);
+	if(bytesRead > 0) commit(bytesRead);
+	return bytesRead;
+}
+
+void LineReader::append(const char* data, size_t size)
+{
+	if(_buffer.size() - _end < size) compact();
+	if(_buffer.size() - _end < size) _buffer.resize(_end + size);
+	memcpy(_buffer.data() + _end, data, size);
+	_end += size;
+}
+
+bool LineReader::nextLine(std::string_view& line)
+{
+	if(_searchPosition < _start) _searchPosition = _start;
+	if(_searchPosition >= _end) return false;
+	//memchr is vectorized by the C library, so every byte is only looked at once and in blocks.
+	const char* lineBreak = (const char*)memchr(_buffer.data() + _searchPosition, '\n', _end - _searchPosition);
+	if(!lineBreak)
+	{
+		_searchPosition = _end;
+		return false;
+	}
+	size_t lineEnd = (lineBreak - _buffer.data()) + 1;
+	line = std::string_view(_buffer.data() + _start, lineEnd - _start);
+	_start = lineEnd;
+	_searchPosition = lineEnd;
+	if(_start == _end) clear();
+	return true;
+}
+
+}
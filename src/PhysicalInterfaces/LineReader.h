@@ -0,0 +1,79 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef HOMEGEAR_MAX_LINEREADER_H
+#define HOMEGEAR_MAX_LINEREADER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace MAX
+{
+
+//Input buffer for line based interfaces like culfw. All data available is read with one system call and split into
+//lines in place. Returned lines point into the buffer and are only valid until the next call to read() or append().
+class LineReader
+{
+public:
+	LineReader(uint32_t maxLineLength);
+	virtual ~LineReader() {}
+
+	//Reads everything available from the file descriptor. Returns the number of bytes read, 0 on end of file and -1 on
+	//errors (see errno).
+	ssize_t read(int32_t fileDescriptor);
+	//Adds data received by other means (e. g. from a socket class)
+	void append(const char* data, size_t size);
+	//Returns the free space at the end of the buffer and sets "size" to its length, so data can be received directly
+	//into the buffer. Call commit() with the number of bytes written afterwards.
+	char* prepare(size_t& size);
+	void commit(size_t size) { _end += size; }
+	//Returns true and sets "line" to the next complete line including the trailing "\n".
+	bool nextLine(std::string_view& line);
+	//True when more than maxLineLength bytes are buffered without a line break. Only meaningful after nextLine() returned false.
+	bool overflow() { return _end - _start > _maxLineLength; }
+	size_t size() { return _end - _start; }
+	void clear();
+protected:
+	std::vector<char> _buffer;
+	size_t _start = 0;
+	size_t _end = 0;
+	//Bytes before this position were already searched for a line break.
+	size_t _searchPosition = 0;
+	uint32_t _maxLineLength = 0;
+
+	//Moves unprocessed data to the beginning of the buffer.
+	void compact();
+};
+
+}
+
+#endif
@@ -0,0 +1,288 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "Reactor.h"
+#include "../GD.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace MAX
+{
+
+Reactor::Reactor()
+{
+	_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	if(_epollDescriptor == -1) throw BaseLib::Exception("Could not create epoll instance: " + std::string(strerror(errno)));
+	_wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(_wakeDescriptor == -1)
+	{
+		close(_epollDescriptor);
+		throw BaseLib::Exception("Could not create event file descriptor: " + std::string(strerror(errno)));
+	}
+	epoll_event event{};
+	event.events = EPOLLIN;
+	event.data.fd = _wakeDescriptor;
+	epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, _wakeDescriptor, &event);
+}
+
+Reactor::~Reactor()
+{
+	stop();
+	close(_wakeDescriptor);
+	close(_epollDescriptor);
+}
+
+void Reactor::start()
+{
+	try
+	{
+		stop();
+		_stopThread = false;
+		GD::bl->threadManager.start(_thread, true, &Reactor::mainThread, this);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void Reactor::stop()
+{
+	try
+	{
+		_stopThread = true;
+		wake();
+		GD::bl->threadManager.join(_thread);
+		_threadId = std::thread::id();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void Reactor::wake()
+{
+	uint64_t value = 1;
+	if(write(_wakeDescriptor, &value, sizeof(value)) == -1 && errno != EAGAIN) GD::out.printError("Error: Could not wake up reactor: " + std::string(strerror(errno)));
+}
+
+void Reactor::waitForHandlers()
+{
+	//Handlers removing themselves would deadlock otherwise.
+	if(std::this_thread::get_id() == _threadId.load()) return;
+	std::lock_guard<std::mutex> dispatchGuard(_dispatchMutex);
+}
+
+bool Reactor::add(int32_t fileDescriptor, uint32_t events, EventHandler handler)
+{
+	try
+	{
+		if(fileDescriptor < 0 || !handler) return false;
+		{
+			std::lock_guard<std::mutex> handlersGuard(_handlersMutex);
+			_handlers[fileDescriptor] = std::make_shared<EventHandler>(std::move(handler));
+		}
+		epoll_event event{};
+		event.events = events | EPOLLET;
+		event.data.fd = fileDescriptor;
+		if(epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) == -1)
+		{
+			GD::out.printError("Error: Could not add file descriptor to reactor: " + std::string(strerror(errno)));
+			std::lock_guard<std::mutex> handlersGuard(_handlersMutex);
+			_handlers.erase(fileDescriptor);
+			return false;
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+void Reactor::remove(int32_t fileDescriptor)
+{
+	try
+	{
+		if(fileDescriptor < 0) return;
+		epoll_ctl(_epollDescriptor, EPOLL_CTL_DEL, fileDescriptor, nullptr);
+		{
+			std::lock_guard<std::mutex> handlersGuard(_handlersMutex);
+			_handlers.erase(fileDescriptor);
+		}
+		waitForHandlers();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+uint64_t Reactor::addTimer(int64_t delay, TimerHandler handler)
+{
+	try
+	{
+		if(!handler) return 0;
+		int64_t dueTime = BaseLib::HelperFunctions::getTime() + delay;
+		uint64_t id = 0;
+		bool first = false;
+		{
+			std::lock_guard<std::mutex> timersGuard(_timersMutex);
+			id = ++_currentTimerId;
+			_timers.emplace(id, std::make_pair(dueTime, std::move(handler)));
+			_timerQueue.emplace(dueTime, id);
+			first = _timerQueue.begin()->second == id;
+		}
+		//The reactor thread might be waiting with a longer timeout
+		if(first) wake();
+		return id;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return 0;
+}
+
+void Reactor::removeTimer(uint64_t id)
+{
+	try
+	{
+		if(id != 0)
+		{
+			std::lock_guard<std::mutex> timersGuard(_timersMutex);
+			auto timerIterator = _timers.find(id);
+			if(timerIterator != _timers.end())
+			{
+				_timerQueue.erase(std::make_pair(timerIterator->second.first, id));
+				_timers.erase(timerIterator);
+			}
+		}
+		//A timer that is not queued anymore might be running right now.
+		waitForHandlers();
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+int32_t Reactor::nextTimeout()
+{
+	std::lock_guard<std::mutex> timersGuard(_timersMutex);
+	if(_timerQueue.empty()) return -1;
+	int64_t timeout = _timerQueue.begin()->first - BaseLib::HelperFunctions::getTime();
+	if(timeout < 0) return 0;
+	return timeout > 60000 ? 60000 : (int32_t)timeout;
+}
+
+void Reactor::runTimers()
+{
+	int64_t now = BaseLib::HelperFunctions::getTime();
+	while(!_stopThread)
+	{
+		TimerHandler handler;
+		{
+			std::lock_guard<std::mutex> timersGuard(_timersMutex);
+			if(_timerQueue.empty() || _timerQueue.begin()->first > now) return;
+			auto timerIterator = _timers.find(_timerQueue.begin()->second);
+			_timerQueue.erase(_timerQueue.begin());
+			if(timerIterator == _timers.end()) continue;
+			handler = std::move(timerIterator->second.second);
+			_timers.erase(timerIterator);
+		}
+		try
+		{
+			handler();
+		}
+		catch(const std::exception& ex)
+		{
+			GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+	}
+}
+
+void Reactor::mainThread()
+{
+	try
+	{
+		_threadId = std::this_thread::get_id();
+		std::array<epoll_event, 32> events;
+		while(!_stopThread)
+		{
+			int32_t eventCount = epoll_wait(_epollDescriptor, events.data(), events.size(), nextTimeout());
+			if(eventCount == -1)
+			{
+				if(errno == EINTR) continue;
+				GD::out.printError("Error: epoll_wait failed: " + std::string(strerror(errno)));
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				continue;
+			}
+
+			std::lock_guard<std::mutex> dispatchGuard(_dispatchMutex);
+			for(int32_t i = 0; i < eventCount && !_stopThread; i++)
+			{
+				if(events[i].data.fd == _wakeDescriptor)
+				{
+					uint64_t value = 0;
+					while(read(_wakeDescriptor, &value, sizeof(value)) > 0);
+					continue;
+				}
+
+				std::shared_ptr<EventHandler> handler;
+				{
+					//Handlers removed by an earlier handler of this batch are skipped here
+					std::lock_guard<std::mutex> handlersGuard(_handlersMutex);
+					auto handlerIterator = _handlers.find(events[i].data.fd);
+					if(handlerIterator == _handlers.end()) continue;
+					handler = handlerIterator->second;
+				}
+				try
+				{
+					(*handler)(events[i].events);
+				}
+				catch(const std::exception& ex)
+				{
+					GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+				}
+			}
+			runTimers();
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+}
@@ -0,0 +1,101 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef HOMEGEAR_MAX_REACTOR_H
+#define HOMEGEAR_MAX_REACTOR_H
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace MAX
+{
+
+//One epoll loop for the file descriptors of all physical interfaces. File descriptors are registered edge triggered, so
+//handlers have to read until EAGAIN. Handlers and timers are called from the reactor thread and must not block.
+//Only CUL uses it: COC goes through BaseLib's serial device manager, Cunx and HomegearGateway through C1Net::TcpSocket
+//which don't expose their file descriptors, and TICC1100 polls its GPIO while holding the TX lock.
+class Reactor
+{
+public:
+	typedef std::function<void(uint32_t events)> EventHandler;
+	typedef std::function<void()> TimerHandler;
+
+	Reactor();
+	virtual ~Reactor();
+
+	void start();
+	void stop();
+
+	//Calls "handler" whenever one of "events" (e. g. EPOLLIN) occurs on "fileDescriptor". EPOLLERR and EPOLLHUP are
+	//always reported.
+	bool add(int32_t fileDescriptor, uint32_t events, EventHandler handler);
+	//After remove() returns the handler is not called anymore. Needs to be called before the file descriptor is closed.
+	void remove(int32_t fileDescriptor);
+	//Calls "handler" once after "delay" milliseconds. Returns an id for removeTimer().
+	uint64_t addTimer(int64_t delay, TimerHandler handler);
+	//After removeTimer() returns the handler is not called anymore and is not running. Also waits when the timer already
+	//fired or "id" is 0.
+	void removeTimer(uint64_t id);
+	//Returns when no handler or timer is running. Returns immediately when called from a handler.
+	void waitForHandlers();
+protected:
+	int32_t _epollDescriptor = -1;
+	int32_t _wakeDescriptor = -1;
+	std::thread _thread;
+	std::atomic_bool _stopThread{false};
+	std::atomic<std::thread::id> _threadId;
+
+	//Held while handlers are executed, so remove() and removeTimer() can wait for running handlers.
+	std::mutex _dispatchMutex;
+
+	std::mutex _handlersMutex;
+	std::unordered_map<int32_t, std::shared_ptr<EventHandler>> _handlers;
+
+	std::mutex _timersMutex;
+	uint64_t _currentTimerId = 0;
+	//Ordered by due time, then by id
+	std::set<std::pair<int64_t, uint64_t>> _timerQueue;
+	std::unordered_map<uint64_t, std::pair<int64_t, TimerHandler>> _timers;
+
+	void mainThread();
+	void wake();
+	//Returns the number of milliseconds until the next timer is due or -1 when no timer is scheduled.
+	int32_t nextTimeout();
+	void runTimers();
+};
+
+}
+
+#endif
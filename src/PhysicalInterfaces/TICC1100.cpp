@@ -58,6 +58,7 @@ TICC1100::TICC1100(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings>
 		}
 
 		_transfer =  { (uint64_t)0, (uint64_t)0, (uint32_t)0, (uint32_t)4000000, (uint16_t)0, (uint8_t)8, (uint8_t)0, (uint32_t)0 };
+		_packetBytes.reserve(64);
 
 		setConfig();
 	}
@@ -73,8 +74,9 @@ TICC1100::~TICC1100()
 	{
 		_stopCallbackThread = true;
 		_bl->threadManager.join(_listenThread);
+		stopTx();
 		closeDevice();
-		closeGPIO(1);
+		closeInterrupt();
 	}
     catch(const std::exception& ex)
     {
@@ -291,19 +293,70 @@ void TICC1100::setupDevice()
     }
 }
 
-void TICC1100::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
+bool TICC1100::openInterrupt()
 {
 	try
 	{
-		if(!packet)
+		_out.printDebug("Debug: CC1100: Setting GPIO direction");
+		setGPIODirection(1, GPIODirection::IN);
+		_out.printDebug("Debug: CC1100: Setting GPIO edge");
+		setGPIOEdge(1, GPIOEdge::BOTH);
+		openGPIO(1, true);
+		if(!_gpioDescriptors[1] || _gpioDescriptors[1]->descriptor == -1) return false;
+		if(gpioDefined(2)) //Enable high gain mode
 		{
-			_out.printWarning("Warning: Packet was nullptr.");
-			return;
+			openGPIO(2, false);
+			if(!getGPIO(2)) setGPIO(2, true);
+			closeGPIO(2);
 		}
-		if(_fileDescriptor->descriptor == -1 || _gpioDescriptors[1]->descriptor == -1 || _stopped) return;
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+void TICC1100::closeInterrupt()
+{
+	try
+	{
+		closeGPIO(1);
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
 
-        std::shared_ptr<MAXPacket> maxPacket(std::dynamic_pointer_cast<MAXPacket>(packet));
-        if(!maxPacket) return;
+bool TICC1100::spiTransfer(struct spi_ioc_transfer* transfers, uint32_t count)
+{
+	return ioctl(_fileDescriptor->descriptor, SPI_IOC_MESSAGE(count), transfers) >= 1;
+}
+
+int32_t TICC1100::waitForInterrupt(int32_t timeout, bool& high)
+{
+	pollfd pollstruct {
+		(int)_gpioDescriptors[1]->descriptor,
+		(short)(POLLPRI | POLLERR),
+		(short)0
+	};
+
+	int32_t pollResult = poll(&pollstruct, 1, timeout);
+	if(pollResult <= 0) return pollResult;
+	if(lseek(_gpioDescriptors[1]->descriptor, 0, SEEK_SET) == -1) throw BaseLib::Exception("Could not poll gpio: " + std::string(strerror(errno)));
+	char value = '0';
+	if(read(_gpioDescriptors[1]->descriptor, &value, 1) != 1) return 0;
+	high = (value != '0');
+	return 1;
+}
+
+void TICC1100::transmit(std::shared_ptr<MAXPacket> maxPacket)
+{
+	try
+	{
+		if(_fileDescriptor->descriptor == -1 || _gpioDescriptors[1]->descriptor == -1 || _stopped) return;
 
 		if(maxPacket->payload().size() > 54)
 		{
@@ -333,16 +386,25 @@ void TICC1100::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 		if(maxPacket->getBurst())
 		{
 			sendCommandStrobe(CommandStrobes::Enum::STX);
-			usleep(1000000);
+			//The chip sends the preamble while the FIFO is empty. The payload is written by the TX thread after one
+			//second, so the caller doesn't wait. The end of the transmission is reported by GDO0 (see mainThread).
+			startBurst(1000, [this, packetBytes]() mutable
+			{
+				if(_stopCallbackThread || _fileDescriptor->descriptor == -1 || _stopped) return;
+				writeRegisters(Registers::Enum::FIFO, packetBytes);
+			});
+		}
+		else
+		{
+			writeRegisters(Registers::Enum::FIFO, packetBytes);
+			sendCommandStrobe(CommandStrobes::Enum::STX);
 		}
-		writeRegisters(Registers::Enum::FIFO, packetBytes);
-		if(!maxPacket->getBurst()) sendCommandStrobe(CommandStrobes::Enum::STX);
 
 		if(_bl->debugLevel > 3)
 		{
-			if(packet->getTimeSending() > 0)
+			if(maxPacket->getTimeSending() > 0)
 			{
-				_out.printInfo("Info: Sending (" + _settings->id + ", WOR: " + (maxPacket->getBurst() ? "yes" : "no") + "): " + maxPacket->hexString() + " Planned sending time: " + BaseLib::HelperFunctions::getTimeString(packet->getTimeSending()));
+				_out.printInfo("Info: Sending (" + _settings->id + ", WOR: " + (maxPacket->getBurst() ? "yes" : "no") + "): " + maxPacket->hexString() + " Planned sending time: " + BaseLib::HelperFunctions::getTimeString(maxPacket->getTimeSending()));
 			}
 			else
 			{
@@ -359,21 +421,26 @@ void TICC1100::sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet)
 }
 
 void TICC1100::readwrite(std::vector<uint8_t>& data)
+{
+	readwrite(data.data(), data.size());
+}
+
+void TICC1100::readwrite(uint8_t* data, uint32_t size)
 {
 	try
 	{
 		_sendMutex.lock();
-		_transfer.tx_buf = (uint64_t)&data[0];
-		_transfer.rx_buf = (uint64_t)&data[0];
-		_transfer.len = (uint32_t)data.size();
-		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Sending: " + _bl->hf.getHexString(data));
-		if(!ioctl(_fileDescriptor->descriptor, SPI_IOC_MESSAGE(1), &_transfer))
+		_transfer.tx_buf = (uint64_t)data;
+		_transfer.rx_buf = (uint64_t)data;
+		_transfer.len = size;
+		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Sending: " + BaseLib::HelperFunctions::getHexString(data, size));
+		if(!spiTransfer(&_transfer, 1))
 		{
 			_sendMutex.unlock();
 			_out.printError("Couldn't write to device " + _settings->device + ": " + std::string(strerror(errno)));
 			return;
 		}
-		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Received: " + _bl->hf.getHexString(data));
+		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Received: " + BaseLib::HelperFunctions::getHexString(data, size));
 		_sendMutex.unlock();
 	}
 	catch(const std::exception& ex)
@@ -403,16 +470,16 @@ uint8_t TICC1100::readRegister(Registers::Enum registerAddress)
 	try
 	{
 		if(_fileDescriptor->descriptor == -1) return 0;
-		std::vector<uint8_t> data({(uint8_t)(registerAddress | RegisterBitmasks::Enum::READ_SINGLE), 0x00});
+		uint8_t data[2];
 		for(uint32_t i = 0; i < 5; i++)
 		{
-			readwrite(data);
-			if(!(data.at(0) & StatusBitmasks::Enum::CHIP_RDYn)) break;
-			data.at(0) = (uint8_t)(registerAddress  | RegisterBitmasks::Enum::READ_SINGLE);
-			data.at(1) = 0;
+			data[0] = (uint8_t)(registerAddress | RegisterBitmasks::Enum::READ_SINGLE);
+			data[1] = 0;
+			readwrite(data, 2);
+			if(!(data[0] & StatusBitmasks::Enum::CHIP_RDYn)) break;
 			usleep(20);
 		}
-		return data.at(1);
+		return data[1];
 	}
     catch(const std::exception& ex)
     {
@@ -421,29 +488,30 @@ uint8_t TICC1100::readRegister(Registers::Enum registerAddress)
     return 0;
 }
 
-std::vector<uint8_t> TICC1100::readRegisters(Registers::Enum startAddress, uint8_t count)
+bool TICC1100::readRegisters(Registers::Enum startAddress, uint8_t* values, uint32_t count)
 {
 	try
 	{
-		if(_fileDescriptor->descriptor == -1) return std::vector<uint8_t>();
-		std::vector<uint8_t> data({(uint8_t)(startAddress | RegisterBitmasks::Enum::READ_BURST)});
-		data.resize(count + 1, 0);
+		if(_fileDescriptor->descriptor == -1 || count == 0 || count >= _registerBuffer.size()) return false;
+		std::lock_guard<std::mutex> registerBufferGuard(_registerBufferMutex);
 		for(uint32_t i = 0; i < 5; i++)
 		{
-			readwrite(data);
-			if(!(data.at(0) & StatusBitmasks::Enum::CHIP_RDYn)) break;
-			data.clear();
-			data.push_back((uint8_t)(startAddress  | RegisterBitmasks::Enum::READ_BURST));
-			data.resize(count + 1, 0);
+			_registerBuffer[0] = (uint8_t)(startAddress | RegisterBitmasks::Enum::READ_BURST);
+			memset(_registerBuffer.data() + 1, 0, count);
+			readwrite(_registerBuffer.data(), count + 1);
+			if(!(_registerBuffer[0] & StatusBitmasks::Enum::CHIP_RDYn))
+			{
+				memcpy(values, _registerBuffer.data() + 1, count);
+				return true;
+			}
 			usleep(20);
 		}
-		return data;
 	}
     catch(const std::exception& ex)
     {
         _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
-    return std::vector<uint8_t>();
+    return false;
 }
 
 uint8_t TICC1100::writeRegister(Registers::Enum registerAddress, uint8_t value, bool check)
@@ -451,16 +519,18 @@ uint8_t TICC1100::writeRegister(Registers::Enum registerAddress, uint8_t value,
 	try
 	{
 		if(_fileDescriptor->descriptor == -1) return 0xFF;
-		std::vector<uint8_t> data({(uint8_t)registerAddress, value});
-		readwrite(data);
-		if((data.at(0) & StatusBitmasks::Enum::CHIP_RDYn) || (data.at(1) & StatusBitmasks::Enum::CHIP_RDYn)) throw BaseLib::Exception("Error writing to register " + std::to_string(registerAddress) + ".");
+		uint8_t data[2];
+		data[0] = (uint8_t)registerAddress;
+		data[1] = value;
+		readwrite(data, 2);
+		if((data[0] & StatusBitmasks::Enum::CHIP_RDYn) || (data[1] & StatusBitmasks::Enum::CHIP_RDYn)) throw BaseLib::Exception("Error writing to register " + std::to_string(registerAddress) + ".");
 
 		if(check)
 		{
-			data.at(0) = registerAddress | RegisterBitmasks::Enum::READ_SINGLE;
-			data.at(1) = 0;
-			readwrite(data);
-			if(data.at(1) != value)
+			data[0] = registerAddress | RegisterBitmasks::Enum::READ_SINGLE;
+			data[1] = 0;
+			readwrite(data, 2);
+			if(data[1] != value)
 			{
 				_out.printError("Error (check) writing to register " + std::to_string(registerAddress) + ".");
 				return 0;
@@ -479,11 +549,17 @@ void TICC1100::writeRegisters(Registers::Enum startAddress, std::vector<uint8_t>
 {
 	try
 	{
-		if(_fileDescriptor->descriptor == -1) return;
-		std::vector<uint8_t> data({(uint8_t)(startAddress | RegisterBitmasks::Enum::WRITE_BURST) });
-		data.insert(data.end(), values.begin(), values.end());
-		readwrite(data);
-		if((data.at(0) & StatusBitmasks::Enum::CHIP_RDYn)) _out.printError("Error writing to registers " + std::to_string(startAddress) + ".");
+		if(_fileDescriptor->descriptor == -1 || values.empty()) return;
+		if(values.size() >= _registerBuffer.size())
+		{
+			_out.printError("Error writing to registers " + std::to_string(startAddress) + ": Too many values.");
+			return;
+		}
+		std::lock_guard<std::mutex> registerBufferGuard(_registerBufferMutex);
+		_registerBuffer[0] = (uint8_t)(startAddress | RegisterBitmasks::Enum::WRITE_BURST);
+		memcpy(_registerBuffer.data() + 1, values.data(), values.size());
+		readwrite(_registerBuffer.data(), values.size() + 1);
+		if((_registerBuffer[0] & StatusBitmasks::Enum::CHIP_RDYn)) _out.printError("Error writing to registers " + std::to_string(startAddress) + ".");
 	}
     catch(const std::exception& ex)
     {
@@ -496,15 +572,15 @@ uint8_t TICC1100::sendCommandStrobe(CommandStrobes::Enum commandStrobe)
 	try
 	{
 		if(_fileDescriptor->descriptor == -1) return 0xFF;
-		std::vector<uint8_t> data({(uint8_t)commandStrobe});
+		uint8_t data = 0;
 		for(uint32_t i = 0; i < 5; i++)
 		{
-			readwrite(data);
-			if(!(data.at(0) & StatusBitmasks::Enum::CHIP_RDYn)) break;
-			data.at(0) = (uint8_t)commandStrobe;
+			data = (uint8_t)commandStrobe;
+			readwrite(&data, 1);
+			if(!(data & StatusBitmasks::Enum::CHIP_RDYn)) break;
 			usleep(20);
 		}
-		return data.at(0);
+		return data;
 	}
     catch(const std::exception& ex)
     {
@@ -513,6 +589,107 @@ uint8_t TICC1100::sendCommandStrobe(CommandStrobes::Enum commandStrobe)
     return 0;
 }
 
+void TICC1100::beginBatch()
+{
+	_batchTransferCount = 0;
+	_batchBufferSize = 0;
+}
+
+uint8_t* TICC1100::addToBatch(uint8_t header, uint32_t size)
+{
+	if(size == 0 || _batchTransferCount >= _batchTransfers.size() || _batchBufferSize + size > _batchBuffer.size()) return nullptr;
+	uint8_t* data = _batchBuffer.data() + _batchBufferSize;
+	data[0] = header;
+	if(size > 1) memset(data + 1, 0, size - 1);
+	_batchBufferSize += size;
+
+	struct spi_ioc_transfer& transfer = _batchTransfers[_batchTransferCount];
+	transfer = _transfer;
+	transfer.tx_buf = (uint64_t)data;
+	transfer.rx_buf = (uint64_t)data;
+	transfer.len = size;
+	if(_batchTransferCount > 0) _batchTransfers[_batchTransferCount - 1].cs_change = 1; //Release chip select between accesses
+	_batchTransferCount++;
+	return data;
+}
+
+bool TICC1100::submitBatch()
+{
+	try
+	{
+		if(_batchTransferCount == 0) return true;
+		if(_fileDescriptor->descriptor == -1) return false;
+		std::lock_guard<std::mutex> sendGuard(_sendMutex);
+		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Sending: " + BaseLib::HelperFunctions::getHexString(_batchBuffer.data(), _batchBufferSize));
+		if(!spiTransfer(_batchTransfers.data(), _batchTransferCount))
+		{
+			_out.printError("Couldn't write to device " + _settings->device + ": " + std::string(strerror(errno)));
+			return false;
+		}
+		if(_bl->debugLevel >= 6) _out.printDebug("Debug: Received: " + BaseLib::HelperFunctions::getHexString(_batchBuffer.data(), _batchBufferSize));
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+TICC1100::RxResult TICC1100::readPacket(std::vector<uint8_t>& packetBytes)
+{
+	try
+	{
+		packetBytes.clear();
+		if(_fileDescriptor->descriptor == -1) return RxResult::crcFailed;
+
+		//First transaction: CRC status and number of bytes in the FIFO
+		uint8_t* lqi = nullptr;
+		uint8_t* rxBytes = nullptr;
+		for(uint32_t i = 0; i < 5; i++)
+		{
+			beginBatch();
+			lqi = addToBatch((uint8_t)(Registers::Enum::LQI | RegisterBitmasks::Enum::READ_BURST), 2);
+			rxBytes = addToBatch((uint8_t)(Registers::Enum::RXBYTES | RegisterBitmasks::Enum::READ_BURST), 2);
+			if(!submitBatch()) return RxResult::crcFailed;
+			if(!(lqi[0] & StatusBitmasks::Enum::CHIP_RDYn)) break;
+			usleep(20);
+		}
+		bool crcOK = lqi[1] & 0x80;
+		//Bit 7 is set on FIFO overflow. The FIFO content is useless then.
+		uint32_t byteCount = (rxBytes[1] & 0x80) ? 0 : (rxBytes[1] & 0x7F);
+
+		//Second transaction: FIFO content including the appended RSSI, then flush and restart RX. The chip ignores the
+		//whole transaction when it isn't ready at its start, so it is repeated like the first one.
+		uint8_t* fifo = nullptr;
+		for(uint32_t i = 0; i < 5; i++)
+		{
+			beginBatch();
+			fifo = (crcOK && byteCount > 0) ? addToBatch((uint8_t)(Registers::Enum::FIFO | RegisterBitmasks::Enum::READ_BURST), byteCount + 1) : nullptr;
+			uint8_t* strobe = _sendingPending ? nullptr : addToBatch((uint8_t)CommandStrobes::Enum::SFRX, 1);
+			if(strobe) addToBatch((uint8_t)CommandStrobes::Enum::SRX, 1);
+			uint8_t* status = fifo ? fifo : strobe;
+			if(!submitBatch()) return RxResult::crcFailed;
+			if(!status || !(status[0] & StatusBitmasks::Enum::CHIP_RDYn)) break;
+			usleep(20);
+		}
+		if(!crcOK) return RxResult::crcFailed;
+		if(!fifo) return RxResult::received;
+
+		//fifo[0] is the status byte. fifo[1] is the length byte, followed by the payload and RSSI.
+		uint32_t length = fifo[1];
+		if(length + 2 > 64) return RxResult::tooLarge;
+		uint32_t size = std::min(length + 2, byteCount);
+		packetBytes.insert(packetBytes.end(), fifo + 1, fifo + 1 + size);
+		return RxResult::received;
+	}
+	catch(const std::exception& ex)
+	{
+		_out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return RxResult::crcFailed;
+}
+
 void TICC1100::enableRX(bool flushRXFIFO)
 {
 	try
@@ -597,21 +774,6 @@ void TICC1100::reset()
     }
 }
 
-bool TICC1100::crcOK()
-{
-	try
-	{
-		if(_fileDescriptor->descriptor == -1) return false;
-		std::vector<uint8_t> result = readRegisters(Registers::Enum::LQI, 1);
-		if((result.size() == 2) && (result.at(1) & 0x80)) return true;
-	}
-    catch(const std::exception& ex)
-    {
-        _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-    }
-    return false;
-}
-
 void TICC1100::startListening()
 {
 	try
@@ -640,18 +802,7 @@ void TICC1100::initDevice()
 		if(!_fileDescriptor || _fileDescriptor->descriptor == -1) return;
 
 		initChip();
-		_out.printDebug("Debug: CC1100: Setting GPIO direction");
-		setGPIODirection(1, GPIODirection::IN);
-		_out.printDebug("Debug: CC1100: Setting GPIO edge");
-		setGPIOEdge(1, GPIOEdge::BOTH);
-		openGPIO(1, true);
-		if(!_gpioDescriptors[1] || _gpioDescriptors[1]->descriptor == -1) throw(BaseLib::Exception("Couldn't listen to rf device, because the gpio pointer is not valid: " + _settings->device));
-		if(gpioDefined(2)) //Enable high gain mode
-		{
-			openGPIO(2, false);
-			if(!getGPIO(2)) setGPIO(2, true);
-			closeGPIO(2);
-		}
+		if(!openInterrupt()) throw(BaseLib::Exception("Couldn't listen to rf device, because the gpio pointer is not valid: " + _settings->device));
 	}
     catch(const std::exception& ex)
     {
@@ -665,9 +816,10 @@ void TICC1100::stopListening()
 	{
 		_stopCallbackThread = true;
 		_bl->threadManager.join(_listenThread);
+		stopTx();
 		_stopCallbackThread = false;
 		if(_fileDescriptor->descriptor != -1) closeDevice();
-		closeGPIO(1);
+		closeInterrupt();
 		_stopped = true;
 		IPhysicalInterface::stopListening();
 	}
@@ -686,6 +838,7 @@ void TICC1100::endSending()
 		sendCommandStrobe(CommandStrobes::Enum::SRX);
 		_sending = false;
 		_lastPacketSent = BaseLib::HelperFunctions::getTime();
+		txCompleted();
 	}
 	catch(const std::exception& ex)
     {
@@ -698,8 +851,7 @@ void TICC1100::mainThread()
     try
     {
 		int32_t pollResult;
-		int32_t bytesRead;
-		std::vector<char> readBuffer({'0'});
+		bool high = false;
 
         while(!_stopCallbackThread)
         {
@@ -713,7 +865,7 @@ void TICC1100::mainThread()
 				if(!_stopCallbackThread && (_fileDescriptor->descriptor == -1 || _gpioDescriptors[1]->descriptor == -1))
 				{
 					_out.printError("Connection to TI CC1101 closed unexpectedly... Trying to reconnect...");
-					_stopped = true; //Set to true, so that sendPacket aborts
+					_stopped = true; //Set to true, so that transmit aborts
 					if(_sending)
 					{
 						std::this_thread::sleep_for(std::chrono::milliseconds(2000));
@@ -721,32 +873,16 @@ void TICC1100::mainThread()
 					}
 					_txMutex.unlock(); //Make sure _txMutex is unlocked
 
-                    closeGPIO(1);
+                    closeInterrupt();
 					initDevice();
 					_stopped = false;
 					continue;
 				}
 
-				pollfd pollstruct {
-					(int)_gpioDescriptors[1]->descriptor,
-					(short)(POLLPRI | POLLERR),
-					(short)0
-				};
-
-				pollResult = poll(&pollstruct, 1, 100);
-				/*if(pollstruct.revents & POLLERR)
-				{
-					_out.printWarning("Warning: Error polling GPIO. Reopening...");
-					closeGPIO();
-					std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-					openGPIO(_settings->gpio1);
-				}*/
+				pollResult = waitForInterrupt(100, high);
 				if(pollResult > 0)
 				{
-					if(lseek(_gpioDescriptors[1]->descriptor, 0, SEEK_SET) == -1) throw BaseLib::Exception("Could not poll gpio: " + std::string(strerror(errno)));
-					bytesRead = read(_gpioDescriptors[1]->descriptor, &readBuffer[0], 1);
-					if(!bytesRead) continue;
-					if(readBuffer.at(0) == 0x30)
+					if(!high)
 					{
 						if(!_sending) _txMutex.try_lock(); //We are receiving, don't send now
 						continue; //Packet is being received. Wait for GDO high
@@ -756,35 +892,29 @@ void TICC1100::mainThread()
 					{
 						//sendCommandStrobe(CommandStrobes::Enum::SIDLE);
 						std::shared_ptr<MAXPacket> packet;
-						if(crcOK())
+						//Also flushes the FIFO and restarts RX unless a packet is waiting to be sent
+						RxResult result = readPacket(_packetBytes);
+						if(result == RxResult::tooLarge)
 						{
-							uint8_t firstByte = readRegister(Registers::Enum::FIFO);
-							std::vector<uint8_t> packetBytes = readRegisters(Registers::Enum::FIFO, firstByte + 1); //Read packet + RSSI
-							packetBytes.at(0) = firstByte;
-							if(packetBytes.size() > 100)
+							if(!_firstPacket)
 							{
-								if(!_firstPacket)
-								{
-									_out.printWarning("Warning: Too large packet received: " + BaseLib::HelperFunctions::getHexString(packetBytes));
-                                    closeDevice();
-									_txMutex.unlock();
-									continue;
-								}
+								_out.printWarning("Warning: Too large packet received.");
+								closeDevice();
+								_txMutex.unlock();
+								continue;
 							}
-							else if(packetBytes.size() >= 9) packet.reset(new MAXPacket(packetBytes, true, BaseLib::HelperFunctions::getTime()));
+						}
+						else if(result == RxResult::received)
+						{
+							if(_packetBytes.size() >= 9) packet.reset(new MAXPacket(_packetBytes, true, BaseLib::HelperFunctions::getTime()));
 							else if(!_firstPacket)
 							{
-								_out.printWarning("Warning: Too small packet received: " + BaseLib::HelperFunctions::getHexString(packetBytes));
+								_out.printWarning("Warning: Too small packet received: " + BaseLib::HelperFunctions::getHexString(_packetBytes));
 								_txMutex.unlock();
 								continue;
 							}
 						}
 						else _out.printDebug("Debug: MAX! packet received, but CRC failed.");
-						if(!_sendingPending)
-						{
-							sendCommandStrobe(CommandStrobes::Enum::SFRX);
-							sendCommandStrobe(CommandStrobes::Enum::SRX);
-						}
 						if(packet)
 						{
 							if(_firstPacket) _firstPacket = false;
@@ -797,9 +927,9 @@ void TICC1100::mainThread()
 				{
 					_txMutex.unlock();
 					_out.printError("Error: Could not poll gpio: " + std::string(strerror(errno)) + ". Reopening...");
-					closeGPIO(1);
+					closeInterrupt();
 					std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-					openGPIO(1, true);
+					openInterrupt();
 				}
 				//pollResult == 0 is timeout
 			}
@@ -47,6 +47,7 @@
 #include <ctime>
 #include <iomanip>
 #include <vector>
+#include <array>
 
 #include <poll.h>
 #include <sys/ioctl.h>
@@ -193,12 +194,13 @@ public:
 		};
 	};
 
+	enum class RxResult { crcFailed, received, tooLarge };
+
 	TICC1100(std::shared_ptr<BaseLib::Systems::PhysicalInterfaceSettings> settings);
 	virtual ~TICC1100();
 
 	void startListening();
 	void stopListening();
-	void sendPacket(std::shared_ptr<BaseLib::Systems::Packet> packet);
 	virtual void setup(int32_t userID, int32_t groupID, bool setPermissions);
 protected:
 	BaseLib::Output _out;
@@ -210,21 +212,58 @@ protected:
 	bool _sendingPending = false;
 	bool _firstPacket = true;
 
+	//{{{ SPI transfer batching
+	//All segments of a batch are submitted with one ioctl. Chip select is released between segments, so each segment is
+	//a separate access to the chip. The buffers are reused, so no memory is allocated while receiving.
+	std::array<struct spi_ioc_transfer, 4> _batchTransfers;
+	std::array<uint8_t, 128> _batchBuffer;
+	uint32_t _batchTransferCount = 0;
+	uint32_t _batchBufferSize = 0;
+	std::vector<uint8_t> _packetBytes;
+
+	void beginBatch();
+	//Adds an access of "size" bytes starting with "header". The remaining bytes are sent as 0. Returns the received
+	//bytes, which are valid after submitBatch(), or nullptr when the batch is full.
+	uint8_t* addToBatch(uint8_t header, uint32_t size);
+	bool submitBatch();
+	//Reads CRC status, FIFO content and RSSI of a received packet and restarts RX. Takes two SPI transactions.
+	RxResult readPacket(std::vector<uint8_t>& packetBytes);
+	//}}}
+
+	//Burst register accesses outside of batches use this buffer, so they don't allocate either. It holds the header byte
+	//and a full FIFO. Packets are sent and received by different threads, so it has its own mutex.
+	std::array<uint8_t, 65> _registerBuffer;
+	std::mutex _registerBufferMutex;
+
+	//{{{ Hardware access
+	//Everything touching the SPI device or the interrupt GPIO goes through these methods, so the hardware can be replaced
+	//(see EmulatedCC1101).
+	virtual void openDevice();
+	virtual void closeDevice();
+	virtual void setupDevice();
+	//Opens GPIO 1 and reports edges of the interrupt pin on it. Returns false on error.
+	virtual bool openInterrupt();
+	virtual void closeInterrupt();
+	//Submits "count" SPI transfers in one transaction
+	virtual bool spiTransfer(struct spi_ioc_transfer* transfers, uint32_t count);
+	//Waits up to "timeout" milliseconds for an edge of the interrupt pin. Returns 1 and sets "high" to the pin level on an
+	//edge, 0 on timeout and -1 on error.
+	virtual int32_t waitForInterrupt(int32_t timeout, bool& high);
+	//}}}
+
+	void transmit(std::shared_ptr<MAXPacket> packet);
 	void setConfig();
-	void setupDevice();
 	void initDevice();
-	void openDevice();
-    void closeDevice();
     void endSending();
     void mainThread();
     void readwrite(std::vector<uint8_t>& data);
+    void readwrite(uint8_t* data, uint32_t size);
     void reset();
     void initChip();
     void enableRX(bool flushRXFIFO);
-    bool crcOK();
     uint8_t sendCommandStrobe(CommandStrobes::Enum commandStrobe);
     uint8_t readRegister(Registers::Enum registerAddress);
-    std::vector<uint8_t> readRegisters(Registers::Enum startAddress, uint8_t count);
+    bool readRegisters(Registers::Enum startAddress, uint8_t* values, uint32_t count);
     uint8_t writeRegister(Registers::Enum registerAddress, uint8_t value, bool check = false);
     void writeRegisters(Registers::Enum startAddress, std::vector<uint8_t>& values);
     bool checkStatus(uint8_t statusByte, Status::Enum status);
@@ -28,6 +28,7 @@
  */
 
 #include "QueueManager.h"
+#include "AddressContextManager.h"
 #include <homegear-base/BaseLib.h>
 #include "GD.h"
 
@@ -67,6 +68,11 @@ void QueueManager::dispose(bool wait)
 {
 	_disposing = true;
 	_stopWorkerThread = true;
+	//Queues are also looked up through the address contexts. Holding _queueMutex, createQueue() can't publish a queue
+	//after this.
+	_queueMutex.lock();
+	if(_addressContexts) _addressContexts->removeQueues();
+	_queueMutex.unlock();
 }
 
 void QueueManager::worker()
@@ -180,6 +186,7 @@ std::shared_ptr<PacketQueue> QueueManager::createQueue(std::shared_ptr<IPhysical
 		queueData->queue->id = _id++;
 		queueData->id = queueData->queue->id;
 		_queues.insert(std::pair<int32_t, std::shared_ptr<QueueData>>(address, queueData));
+		if(_addressContexts && !_disposing) _addressContexts->setQueue(address, queueData);
 		_queueMutex.unlock();
 		GD::out.printDebug("Creating SAVEPOINT PacketQueue" + std::to_string(address) + "_" + std::to_string(queueData->id));
 		raiseCreateSavepoint("PacketQueue" + std::to_string(address) + "_" + std::to_string(queueData->id));
@@ -226,6 +233,7 @@ void QueueManager::resetQueue(int32_t address, uint32_t id)
 			}
 			GD::out.printDebug("Debug: Deleting queue " + std::to_string(id) + " for peer with address 0x" + BaseLib::HelperFunctions::getHexString(address));
 			_queues.erase(address);
+			if(_addressContexts) _addressContexts->removeQueue(address, id);
 			if(!queue->queue->isEmpty() && queue->queue->getQueueType() != PacketQueueType::PAIRING)
 			{
 				peer = queue->queue->peer;
@@ -240,7 +248,7 @@ void QueueManager::resetQueue(int32_t address, uint32_t id)
 		//so we need to unlock first
 		if(_queues.empty()) _stopWorkerThread = true;
 		_queueMutex.unlock();
-		if(setUnreach) peer->serviceMessages->setUnreach(true, true);
+		if(setUnreach) peer->setUnreach(true, true);
 	}
 	catch(const std::exception& ex)
     {
@@ -44,6 +44,7 @@ using namespace BaseLib::Systems;
 namespace MAX
 {
 enum class PacketQueueType;
+class AddressContextManager;
 
 class QueueData
 {
@@ -71,6 +72,8 @@ public:
 	QueueManager();
 	virtual ~QueueManager();
 
+	void setAddressContexts(AddressContextManager* addressContexts) { _addressContexts = addressContexts; }
+
 	std::shared_ptr<PacketQueue> get(int32_t address);
 	std::shared_ptr<PacketQueue> createQueue(std::shared_ptr<BaseLib::Systems::IPhysicalInterface> physicalInterface, PacketQueueType queueType, int32_t address);
 	void resetQueue(int32_t address, uint32_t id);
@@ -85,6 +88,7 @@ protected:
 	uint32_t _id = 0;
 	std::unordered_map<int32_t, std::shared_ptr<QueueData>> _queues;
 	std::mutex _queueMutex;
+	AddressContextManager* _addressContexts = nullptr;
 
 	void worker();
 	//Event handling
@@ -0,0 +1,193 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "ReceiveDispatcher.h"
+#include "MAXCentral.h"
+#include "GD.h"
+
+namespace MAX
+{
+ReceiveDispatcher::ReceiveDispatcher()
+{
+	_started = false;
+	_stopThreads = false;
+	_droppedPackets = 0;
+}
+
+ReceiveDispatcher::~ReceiveDispatcher()
+{
+	stop();
+}
+
+void ReceiveDispatcher::start(MAXCentral* central, uint32_t threadCount, const std::vector<std::string>& interfaceIds)
+{
+	try
+	{
+		if(_started || !central) return;
+		if(threadCount == 0) threadCount = 1;
+		_central = central;
+		_interfaceIds = interfaceIds;
+		_interfaceIndexes.clear();
+		for(uint32_t i = 0; i < _interfaceIds.size(); i++)
+		{
+			_interfaceIndexes[_interfaceIds[i]] = i;
+		}
+
+		_shards.clear();
+		_shards.reserve(threadCount);
+		for(uint32_t i = 0; i < threadCount; i++)
+		{
+			std::unique_ptr<Shard> shard(new Shard());
+			shard->waiting = false;
+			for(uint32_t j = 0; j < _interfaceIds.size(); j++)
+			{
+				shard->queues.emplace_back(new SpscQueue<ReceivedPacket>(_queueSize));
+			}
+			_shards.push_back(std::move(shard));
+		}
+
+		_stopThreads = false;
+		for(uint32_t i = 0; i < _shards.size(); i++)
+		{
+			GD::bl->threadManager.start(_shards[i]->thread, true, GD::bl->settings.workerThreadPriority(), GD::bl->settings.workerThreadPolicy(), &ReceiveDispatcher::worker, this, i);
+		}
+		_started = true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void ReceiveDispatcher::stop()
+{
+	try
+	{
+		_started = false;
+		_stopThreads = true;
+		for(auto& shard : _shards)
+		{
+			{
+				std::lock_guard<std::mutex> waitGuard(shard->waitMutex);
+			}
+			shard->waitConditionVariable.notify_all();
+			GD::bl->threadManager.join(shard->thread);
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+bool ReceiveDispatcher::dispatch(const std::string& interfaceId, std::shared_ptr<MAXPacket>& packet)
+{
+	try
+	{
+		if(!_started || !packet) return false;
+		auto interfaceIterator = _interfaceIndexes.find(interfaceId);
+		if(interfaceIterator == _interfaceIndexes.end()) return false;
+
+		Shard& shard = *_shards[(uint32_t)packet->senderAddress() % _shards.size()];
+		ReceivedPacket receivedPacket;
+		receivedPacket.interfaceIndex = interfaceIterator->second;
+		receivedPacket.packet = packet;
+		if(!shard.queues[interfaceIterator->second]->push(std::move(receivedPacket)))
+		{
+			_droppedPackets++;
+			GD::out.printWarning("Warning: Receive queue is full. Dropping packet from interface " + interfaceId + ": " + packet->hexString());
+			return true;
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(shard.waiting)
+		{
+			{
+				std::lock_guard<std::mutex> waitGuard(shard.waitMutex);
+			}
+			shard.waitConditionVariable.notify_one();
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+void ReceiveDispatcher::worker(uint32_t shardIndex)
+{
+	try
+	{
+		Shard& shard = *_shards[shardIndex];
+		ReceivedPacket receivedPacket;
+		while(!_stopThreads)
+		{
+			try
+			{
+				bool processed = false;
+				for(uint32_t i = 0; i < shard.queues.size(); i++)
+				{
+					//Process one packet per interface and round, so a busy interface can't starve the others
+					if(!shard.queues[i]->pop(receivedPacket)) continue;
+					processed = true;
+					_central->processReceivedPacket(_interfaceIds[receivedPacket.interfaceIndex], receivedPacket.packet);
+					receivedPacket.packet.reset();
+				}
+				if(processed) continue;
+
+				std::unique_lock<std::mutex> waitGuard(shard.waitMutex);
+				shard.waiting = true;
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				bool empty = true;
+				for(auto& queue : shard.queues)
+				{
+					if(!queue->empty())
+					{
+						empty = false;
+						break;
+					}
+				}
+				//The timeout is only a safety net. Producers notify us when we are waiting.
+				if(empty && !_stopThreads) shard.waitConditionVariable.wait_for(waitGuard, std::chrono::milliseconds(1000));
+				shard.waiting = false;
+			}
+			catch(const std::exception& ex)
+			{
+				GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+}
@@ -0,0 +1,97 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef RECEIVEDISPATCHER_H_
+#define RECEIVEDISPATCHER_H_
+
+#include <homegear-base/BaseLib.h>
+#include "MAXPacket.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace MAX
+{
+class MAXCentral;
+
+//Moves packet processing off the interfaces' listen threads. Packets are sharded by sender address, so packets of one
+//device are always processed in order by the same thread. Every interface gets its own SPSC queue per shard, so
+//dispatch() must never be called for the same interface from two threads at once. Interfaces with more than one
+//receiving thread (e. g. CocGroup) serialize their calls.
+class ReceiveDispatcher
+{
+public:
+	ReceiveDispatcher();
+	virtual ~ReceiveDispatcher();
+
+	void start(MAXCentral* central, uint32_t threadCount, const std::vector<std::string>& interfaceIds);
+	void stop();
+
+	//Returns false when the packet can't be dispatched and needs to be processed by the caller.
+	bool dispatch(const std::string& interfaceId, std::shared_ptr<MAXPacket>& packet);
+	uint64_t droppedPackets() { return _droppedPackets; }
+protected:
+	class ReceivedPacket
+	{
+	public:
+		uint32_t interfaceIndex = 0;
+		std::shared_ptr<MAXPacket> packet;
+	};
+
+	class Shard
+	{
+	public:
+		std::vector<std::unique_ptr<SpscQueue<ReceivedPacket>>> queues;
+		std::mutex waitMutex;
+		std::condition_variable waitConditionVariable;
+		std::atomic_bool waiting;
+		std::thread thread;
+	};
+
+	static const uint32_t _queueSize = 256;
+	MAXCentral* _central = nullptr;
+	std::atomic_bool _started;
+	std::atomic_bool _stopThreads;
+	std::atomic<uint64_t> _droppedPackets;
+	std::vector<std::string> _interfaceIds;
+	std::unordered_map<std::string, uint32_t> _interfaceIndexes;
+	std::vector<std::unique_ptr<Shard>> _shards;
+
+	void worker(uint32_t shardIndex);
+};
+
+}
+#endif
@@ -0,0 +1,186 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#include "ServiceMessageIndex.h"
+#include "GD.h"
+
+namespace MAX
+{
+
+ServiceMessageIndex::Flag ServiceMessageIndex::getFlag(const std::string& name)
+{
+	for(uint32_t i = 0; i < flagCount; i++)
+	{
+		if(getName((Flag)i) == name) return (Flag)i;
+	}
+	return flagCount;
+}
+
+const std::string& ServiceMessageIndex::getName(Flag flag)
+{
+	static const std::string names[flagCount + 1]{ "UNREACH", "LOWBAT", "CONFIG_PENDING", "CENTRAL_ADDRESS_SPOOFED", "" };
+	return names[flag < flagCount ? flag : flagCount];
+}
+
+uint32_t ServiceMessageIndex::getSlot(uint64_t peerId)
+{
+	auto slotIterator = _slots.find(peerId);
+	if(slotIterator != _slots.end()) return slotIterator->second;
+	uint32_t slot = 0;
+	if(!_freeSlots.empty())
+	{
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+		_peerIds[slot] = peerId;
+	}
+	else
+	{
+		slot = _peerIds.size();
+		_peerIds.push_back(peerId);
+		if(slot / 64 >= _bits[0].size())
+		{
+			for(uint32_t i = 0; i < flagCount; i++) _bits[i].push_back(0);
+		}
+	}
+	_slots.emplace(peerId, slot);
+	return slot;
+}
+
+void ServiceMessageIndex::set(uint64_t peerId, Flag flag, bool value)
+{
+	try
+	{
+		if(peerId == 0 || flag >= flagCount) return;
+		std::lock_guard<std::mutex> indexGuard(_indexMutex);
+		if(!value && _slots.find(peerId) == _slots.end()) return;
+		uint32_t slot = getSlot(peerId);
+		uint64_t& word = _bits[flag][slot / 64];
+		uint64_t bit = 1ull << (slot % 64);
+		if(((word & bit) != 0) == value) return;
+		if(value)
+		{
+			word |= bit;
+			_counts[flag]++;
+		}
+		else
+		{
+			word &= ~bit;
+			_counts[flag]--;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void ServiceMessageIndex::remove(uint64_t peerId)
+{
+	try
+	{
+		std::lock_guard<std::mutex> indexGuard(_indexMutex);
+		auto slotIterator = _slots.find(peerId);
+		if(slotIterator == _slots.end()) return;
+		uint32_t slot = slotIterator->second;
+		uint64_t bit = 1ull << (slot % 64);
+		for(uint32_t i = 0; i < flagCount; i++)
+		{
+			uint64_t& word = _bits[i][slot / 64];
+			if(word & bit) _counts[i]--;
+			word &= ~bit;
+		}
+		_peerIds[slot] = 0;
+		_freeSlots.push_back(slot);
+		_slots.erase(slotIterator);
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void ServiceMessageIndex::clear()
+{
+	std::lock_guard<std::mutex> indexGuard(_indexMutex);
+	_slots.clear();
+	_peerIds.clear();
+	_freeSlots.clear();
+	for(uint32_t i = 0; i < flagCount; i++)
+	{
+		_bits[i].clear();
+		_counts[i] = 0;
+	}
+}
+
+std::vector<uint64_t> ServiceMessageIndex::get(uint32_t flagMask, bool all)
+{
+	std::vector<uint64_t> peerIds;
+	try
+	{
+		flagMask &= (1u << flagCount) - 1;
+		if(flagMask == 0) return peerIds;
+		std::lock_guard<std::mutex> indexGuard(_indexMutex);
+		uint32_t resultSize = 0;
+		for(uint32_t i = 0; i < flagCount; i++)
+		{
+			if(flagMask & (1u << i)) resultSize += _counts[i];
+		}
+		if(resultSize == 0) return peerIds;
+		peerIds.reserve(resultSize);
+		for(uint32_t wordIndex = 0; wordIndex < _bits[0].size(); wordIndex++)
+		{
+			uint64_t word = all ? 0xFFFFFFFFFFFFFFFFull : 0;
+			for(uint32_t i = 0; i < flagCount; i++)
+			{
+				if(!(flagMask & (1u << i))) continue;
+				if(all) word &= _bits[i][wordIndex];
+				else word |= _bits[i][wordIndex];
+			}
+			while(word)
+			{
+				uint32_t bitIndex = __builtin_ctzll(word);
+				peerIds.push_back(_peerIds[wordIndex * 64 + bitIndex]);
+				word &= word - 1;
+			}
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		GD::out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return peerIds;
+}
+
+uint32_t ServiceMessageIndex::count(Flag flag)
+{
+	std::lock_guard<std::mutex> indexGuard(_indexMutex);
+	return flag < flagCount ? _counts[flag] : 0;
+}
+
+}
@@ -0,0 +1,82 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef SERVICEMESSAGEINDEX_H_
+#define SERVICEMESSAGEINDEX_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MAX
+{
+
+//Bitsets of the peers having one of the indexed service messages set. Every peer gets a dense slot, so a query only
+//scans one bit per peer and touches the peers in the result.
+class ServiceMessageIndex
+{
+public:
+	enum Flag : uint32_t
+	{
+		unreach = 0,
+		lowbat,
+		configPending,
+		centralAddressSpoofed,
+		flagCount
+	};
+
+	ServiceMessageIndex() {}
+	virtual ~ServiceMessageIndex() {}
+
+	//Returns flagCount for service messages which are not indexed.
+	static Flag getFlag(const std::string& name);
+	static const std::string& getName(Flag flag);
+
+	void set(uint64_t peerId, Flag flag, bool value);
+	void remove(uint64_t peerId);
+	void clear();
+
+	//Peers having at least one (or all when "all" is true) of the flags in flagMask set. Bit n of flagMask is Flag n.
+	std::vector<uint64_t> get(uint32_t flagMask, bool all);
+	uint32_t count(Flag flag);
+protected:
+	std::mutex _indexMutex;
+	std::unordered_map<uint64_t, uint32_t> _slots;
+	std::vector<uint64_t> _peerIds;
+	std::vector<uint32_t> _freeSlots;
+	std::vector<uint64_t> _bits[flagCount];
+	uint32_t _counts[flagCount] = {};
+
+	uint32_t getSlot(uint64_t peerId);
+};
+
+}
+#endif
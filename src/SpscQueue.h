@@ -0,0 +1,88 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * Homegear is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Homegear is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Homegear.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+ */
+
+#ifndef SPSCQUEUE_H_
+#define SPSCQUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace MAX
+{
+//Bounded lock free ring buffer for exactly one producer and one consumer thread. Concurrent push() or pop() calls
+//corrupt the queue. Callers need to serialize them when more than one thread can produce or consume.
+template<typename T>
+class SpscQueue
+{
+public:
+	SpscQueue(uint32_t capacity)
+	{
+		uint32_t size = 2;
+		while(size < capacity) size <<= 1;
+		_buffer.resize(size);
+		_mask = size - 1;
+		_head = 0;
+		_tail = 0;
+	}
+	virtual ~SpscQueue() {}
+
+	uint32_t capacity() { return _mask + 1; }
+	bool empty() { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+	uint32_t size() { return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire); }
+
+	//Only to be called by the producer. Returns false when the queue is full.
+	bool push(T&& item)
+	{
+		uint32_t tail = _tail.load(std::memory_order_relaxed);
+		if(tail - _head.load(std::memory_order_acquire) > _mask) return false;
+		_buffer[tail & _mask] = std::move(item);
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Only to be called by the consumer.
+	bool pop(T& item)
+	{
+		uint32_t head = _head.load(std::memory_order_relaxed);
+		if(head == _tail.load(std::memory_order_acquire)) return false;
+		item = std::move(_buffer[head & _mask]);
+		_buffer[head & _mask] = T();
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+protected:
+	std::vector<T> _buffer;
+	uint32_t _mask = 0;
+	alignas(64) std::atomic<uint32_t> _head;
+	alignas(64) std::atomic<uint32_t> _tail;
+};
+
+}
+#endif